@@ -37,6 +37,7 @@
  * 4: timeout: response to high time
  * 5: timeout: signal low timeout
  * 6: timeout: signal high timeout
+ * 7: checksum error
  *
  * Read the datasheet for more information about the times.
  */
@@ -47,6 +48,13 @@
 #include <avr/io.h>
 #include <util/delay.h>
 
+#include "clock.h"
+
+#ifdef AM2302_CAPTURE
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#endif
+
 //#include "main.h"
 
 #define SENSOR_sda_out		DDR_SENSOR |= (1 << SENSOR)
@@ -65,8 +73,63 @@ inline void am2302_init(void)
 	SENSOR_sda_low;
 }
 
-uint8_t am2302(uint16_t *humidity, uint16_t *temp)
+static uint8_t _am2302_result(uint8_t sensor_data[5], uint16_t *humidity, uint16_t *temp)
+{
+	// checksum
+	if ( ((sensor_data[0] + sensor_data[1] + sensor_data[2] + sensor_data[3]) & 0xff ) != sensor_data[4])
+	{
+		return 7;
+	}
+
+	*humidity = (sensor_data[0] << 8) + sensor_data[1];
+	*temp = (sensor_data[2] << 8) + sensor_data[3];
+
+	return 0;
+}
+
+#ifdef AM2302_CAPTURE
+
+/*
+ * Edge capture
+ *
+ * Every edge on the sda pin raises a pin change interrupt that stores the
+ * Timer0 count. The capture runs at CLOCK_FAST_SHIFT (8MHz), Timer0 at CK/8
+ * counts in 1us. At 1MHz the interrupt itself would take longer than the
+ * 26us high time of a "0" bit.
+ *
+ * edge 0: response low, edge 1: response high,
+ * edge 2+2i: start of bit i (low), edge 3+2i: bit i high, the high time is
+ * measured up to the next falling edge.
+ */
+#define AM2302_EDGES		83
+#define AM2302_TIMEOUT_OVF	32	// 8ms in 256us Timer0 overflows
+
+static uint8_t * volatile _am2302_buf = 0;
+static volatile uint8_t _am2302_count = 0;
+static volatile uint8_t _am2302_ovf = 0;
+
+ISR(PCINT0_vect)
+{
+	if (!_am2302_count && !SENSOR_is_low)
+	{
+		return; // the pull-up after the release, edge 0 is the falling response
+	}
+	if (_am2302_buf && _am2302_count < AM2302_EDGES)
+	{
+		_am2302_buf[_am2302_count++] = TCNT0;
+	}
+}
+
+ISR(TIMER0_OVF_vect)
+{
+	_am2302_ovf++;
+}
+
+static uint8_t _am2302_capture(uint16_t *humidity, uint16_t *temp)
 {
+	uint8_t edges[AM2302_EDGES];
+	uint8_t count;
+
 	if (SENSOR_is_low)
 	{
 		// bus not free
@@ -75,7 +138,102 @@ uint8_t am2302(uint16_t *humidity, uint16_t *temp)
 
 	SENSOR_sda_out;
 	SENSOR_sda_low;	// MCU start signal
-	_delay_ms(20);	// start signal (pull sda down for min 0.8ms and maximum 20ms)
+	clock_idle_ms(2); // start signal (pull sda down for min 0.8ms and maximum 20ms)
+
+	uint8_t prr = PRR;
+	PRR &= ~(1 << PRTIM0);
+	clock_scale(CLOCK_FAST_SHIFT);
+	_am2302_buf = edges;
+	_am2302_count = 0;
+	_am2302_ovf = 0;
+	TCCR0A = 0;
+	TCNT0 = 0;
+	TIFR = (1 << TOV0);
+	TIMSK |= (1 << TOIE0);
+	TCCR0B = (1 << CS01); // CK/8
+
+	// armed before the release, so no response edge can slip in between
+	PCMSK |= (1 << SENSOR);
+	GIFR = (1 << PCIF);
+	GIMSK |= (1 << PCIE);
+	SENSOR_sda_in;
+
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	while (1)
+	{
+		cli();
+		if (_am2302_count >= AM2302_EDGES || _am2302_ovf >= AM2302_TIMEOUT_OVF)
+		{
+			sei();
+			break;
+		}
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+	}
+
+	GIMSK &= ~(1 << PCIE);
+	PCMSK &= ~(1 << SENSOR);
+	TCCR0B = 0;
+	TIMSK &= ~(1 << TOIE0);
+	_am2302_buf = 0;
+	count = _am2302_count;
+	clock_scale(0);
+	PRR = prr;
+
+	/*
+	 * times in us, min typ max, widened by the interrupt latency
+	 *      response low time: 75  80  85
+	 *     response high time: 75  80  85
+	 *    signal 0 high time: 22  26  30     (bit=0)
+	 *    signal 1 high time: 68  70  75     (bit=1)
+	 *  signal 0,1 down time: 48  50  55
+	 */
+	if (count < 1) return 2;
+	if (count < 2) return 3;
+	if (count < 3) return 4;
+
+	uint8_t t = edges[1] - edges[0];
+	if (t < 65 || t > 95) return 3;
+	t = edges[2] - edges[1];
+	if (t < 65 || t > 95) return 4;
+
+	if (count < AM2302_EDGES) return 5;
+
+	uint8_t sensor_data[5] = {0};
+	for (uint8_t i = 0; i < 40; i++)
+	{
+		uint8_t low = edges[3 + 2*i] - edges[2 + 2*i];
+		uint8_t high = edges[4 + 2*i] - edges[3 + 2*i];
+
+		if (low > 65) return 5;
+		if (high > 85) return 6;
+
+		sensor_data[i / 8] <<= 1;
+		if (high > 48)
+		{
+			sensor_data[i / 8] |= 1;
+		}
+	}
+
+	return _am2302_result(sensor_data, humidity, temp);
+}
+
+#endif /* AM2302_CAPTURE */
+
+// polling loops at F_CPU, fallback of the capture
+static uint8_t _am2302_poll(uint16_t *humidity, uint16_t *temp)
+{
+	if (SENSOR_is_low)
+	{
+		// bus not free
+		return 1;
+	}
+
+	SENSOR_sda_out;
+	SENSOR_sda_low;	// MCU start signal
+	clock_idle_ms(20);	// start signal (pull sda down for min 0.8ms and maximum 20ms)
 	SENSOR_sda_in;
 
 	// Bus master has released time min: 20us, typ: 30us, max: 200us
@@ -166,14 +324,26 @@ uint8_t am2302(uint16_t *humidity, uint16_t *temp)
 		sensor_data[i] = sensor_byte;
 	}
 
-	// checksum
-	if ( ((sensor_data[0] + sensor_data[1] + sensor_data[2] + sensor_data[3]) & 0xff ) != sensor_data[4])
-	{
-		return 7;
-	}
+	return _am2302_result(sensor_data, humidity, temp);
+}
 
-	*humidity = (sensor_data[0] << 8) + sensor_data[1];
-	*temp = (sensor_data[2] << 8) + sensor_data[3];
+static uint8_t _am2302_fast = 0;
 
-	return 0;
+// ok: Vcc is high enough for CLOCK_FAST_SHIFT, set before every am2302()
+void am2302_fast_ok(uint8_t ok)
+{
+	_am2302_fast = ok;
+}
+
+// the capture (AM2302_CAPTURE) falls back to the polling loops at F_CPU
+// unless am2302_fast_ok() allowed the 8MHz clock
+uint8_t am2302(uint16_t *humidity, uint16_t *temp)
+{
+#ifdef AM2302_CAPTURE
+	if (_am2302_fast)
+	{
+		return _am2302_capture(humidity, temp);
+	}
+#endif
+	return _am2302_poll(humidity, temp);
 }
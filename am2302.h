@@ -24,8 +24,14 @@
 #define PIN_SENSOR   PINB
 #define SENSOR       PB4
 
+// decode the response from edge timestamps (Timer0 + pin change interrupt)
+// instead of polling loops, the CPU sleeps in idle between the edges
+// only used while am2302_fast_ok() says Vcc allows the 8MHz clock
+//#define AM2302_CAPTURE
+
 
 uint8_t am2302(uint16_t *humidity, uint16_t *temp);
+void am2302_fast_ok(uint8_t ok);
 inline void am2302_init(void);
 
 
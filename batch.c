@@ -0,0 +1,138 @@
+/*
+ * batch.c
+ *
+ * Store and forward of readings (USE_BATCH in main.h).
+ */
+
+#include "batch.h"
+
+#ifdef USE_BATCH
+
+#include "native.h"
+#include "radio.h"
+#include "scheduler.h"
+#include "jitter.h"
+
+#if BATCH_BYTES(BATCH_SAMPLES) > RADIO_FRAME_BYTES
+#error "RADIO_FRAME_BYTES too small for BATCH_SAMPLES"
+#endif
+
+static batch_slot_t _batch[REPORT_SLOTS];
+
+static uint8_t _batch_fits(int16_t delta)
+{
+	return delta <= 127 && delta > BATCH_BREAK;
+}
+
+// the break delta is still in the ring
+static uint8_t _batch_has_break(const batch_slot_t *b)
+{
+	return b->break_age != BATCH_NONE && b->break_age + 2 <= b->count;
+}
+
+// humidity in 0.1 %, BATCH_NO_HUMIDITY for temperature only sensors
+void batch_add(uint8_t slot, uint8_t id, int16_t temperature, uint16_t humidity)
+{
+	batch_slot_t *b = &_batch[slot];
+	uint16_t now = scheduler_now();
+
+	if (!_batch_has_break(b)) {
+		b->break_age = BATCH_NONE;
+	}
+	if (b->count) {
+		int16_t dt = temperature - b->temp;
+		int16_t dh = humidity - b->humidity;
+
+		if (++b->head >= BATCH_SAMPLES - 1) {
+			b->head = 0;
+		}
+		if (b->break_age != BATCH_NONE) {
+			b->break_age++;
+		}
+		batch_delta_t *d = &b->delta[b->head];
+		d->ticks = now - b->time;
+		if (_batch_fits(dt) && _batch_fits(dh)) {
+			d->temp = dt;
+			d->humidity = dh;
+		} else {
+			// restart the chain, only one full value is kept
+			if (b->break_age != BATCH_NONE) {
+				b->count = b->break_age; // samples after the older break
+			}
+			b->break_age = 0;
+			b->break_temp = b->temp;
+			b->break_humidity = b->humidity;
+			d->temp = BATCH_BREAK;
+			d->humidity = 0;
+		}
+	} else {
+		b->break_age = BATCH_NONE;
+	}
+	if (b->count < BATCH_SAMPLES) {
+		b->count++;
+	}
+	b->id = id;
+	b->time = now;
+	b->temp = temperature;
+	b->humidity = humidity;
+	b->fresh++;
+}
+
+// send a burst for every sensor ID with BATCH_EVERY new samples
+// returns the ms spent transmitting and napping in between
+uint16_t batch_send(uint8_t battery_ok, uint8_t repeatCount)
+{
+	uint8_t frame[BATCH_BYTES(BATCH_SAMPLES)];
+	uint8_t sent = 0;
+	uint16_t busy = 0;
+
+	for (uint8_t slot = 0; slot < REPORT_SLOTS; slot++) {
+		batch_slot_t *b = &_batch[slot];
+		uint8_t humidity = (b->humidity != BATCH_NO_HUMIDITY);
+		uint8_t len = 0;
+		uint8_t i = b->head;
+		uint8_t brk = _batch_has_break(b) ? b->break_age : BATCH_NONE;
+
+		if (b->fresh < BATCH_EVERY) {
+			continue;
+		}
+		b->fresh = 0;
+
+		frame[len++] = BATCH_MAGIC | (battery_ok ? 0x08 : 0x00) | (humidity ? BATCH_HUMIDITY : 0);
+		frame[len++] = b->id;
+		frame[len++] = b->count;
+		frame[len++] = b->temp >> 8;
+		frame[len++] = b->temp & 0xFF;
+		if (humidity) {
+			frame[len++] = b->humidity >> 8;
+			frame[len++] = b->humidity & 0xFF;
+		}
+		for (uint8_t n = 1; n < b->count; n++) {
+			batch_delta_t *d = &b->delta[i];
+			frame[len++] = d->ticks >> 8;
+			frame[len++] = d->ticks & 0xFF;
+			if (n - 1 == brk) {
+				frame[len++] = BATCH_BREAK;
+				frame[len++] = b->break_temp >> 8;
+				frame[len++] = b->break_temp & 0xFF;
+				if (humidity) {
+					frame[len++] = b->break_humidity >> 8;
+					frame[len++] = b->break_humidity & 0xFF;
+				}
+			} else {
+				frame[len++] = d->temp;
+				if (humidity) {
+					frame[len++] = d->humidity;
+				}
+			}
+			i = i ? i - 1 : BATCH_SAMPLES - 2;
+		}
+		if (sent++) {
+			busy += jitter_nap();
+		}
+		busy += native_transmit(frame, len, repeatCount);
+	}
+	return busy;
+}
+
+#endif /* USE_BATCH */
@@ -0,0 +1,69 @@
+/*
+ * batch.h
+ *
+ * Store and forward of readings (USE_BATCH in main.h).
+ *
+ * Every reading of a sensor ID is kept in a ring of BATCH_SAMPLES: the
+ * newest sample as is and the older ones as deltas to their successor,
+ * with the scheduler ticks between them, so adaptive periods survive.
+ * After BATCH_EVERY new readings the ring is sent as one burst frame with
+ * the native coding (native_transmit()), the radio start-up and sync are
+ * paid once for all samples.
+ *
+ * Burst frame, MSB first:
+ *   header    magic 0xB (4), battery ok (1), humidity (1), 0 (2)
+ *   id        sensor ID (8)
+ *   count     samples in the frame (8)
+ *   newest    temperature in 0.1 C (16), humidity in 0.1 % (16, if flagged)
+ *   older     count - 1 times, newest first: ticks to the next newer
+ *             sample (16), temperature and humidity (if flagged) below the
+ *             next newer sample (8 each, signed)
+ *             or, if the change did not fit: ticks (16), BATCH_BREAK (8),
+ *             the full temperature (16) and humidity (16, if flagged)
+ *   crc       onewire_crc() over all bytes before
+ *
+ * A change beyond +-127 restarts the delta chain. The full value of the
+ * older sample is kept for one such break per sensor ID, samples before an
+ * earlier break are dropped. host/native_decode rebuilds the series with
+ * times relative to the burst.
+ */
+
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <stdint.h>
+
+#include "main.h"
+#include "report.h"
+
+#define BATCH_MAGIC			0xB0
+#define BATCH_HUMIDITY		0x04	// header flag
+#define BATCH_NO_HUMIDITY	0xFFFF
+#define BATCH_BREAK			((int8_t)0x80)	// delta did not fit, full value follows
+#define BATCH_NONE			0xFF	// no break in the ring
+#define BATCH_BYTES(samples)	(7 + ((samples) - 1) * 4 + 3 + 1)	// with humidity, one break and crc
+
+typedef struct {
+	uint16_t ticks;			// scheduler ticks after the previous sample
+	int8_t temp;			// change against the previous sample or BATCH_BREAK
+	int8_t humidity;
+} batch_delta_t;
+
+typedef struct {
+	uint8_t id;
+	uint8_t count;			// samples held, up to BATCH_SAMPLES
+	uint8_t head;			// delta of the newest sample
+	uint8_t fresh;			// samples since the last burst
+	uint16_t time;			// scheduler tick of the newest sample
+	int16_t temp;			// newest sample
+	uint16_t humidity;		// BATCH_NO_HUMIDITY for temperature only sensors
+	uint8_t break_age;		// deltas newer than the break, BATCH_NONE if none
+	int16_t break_temp;		// sample before the break
+	uint16_t break_humidity;
+	batch_delta_t delta[BATCH_SAMPLES - 1];
+} batch_slot_t;
+
+void batch_add(uint8_t slot, uint8_t id, int16_t temperature, uint16_t humidity);
+uint16_t batch_send(uint8_t battery_ok, uint8_t repeatCount);
+
+#endif /* BATCH_H_ */
@@ -0,0 +1,47 @@
+/*
+ * battery.c
+ *
+ * Supply voltage measurement with the internal 1.1V bandgap.
+ */
+
+#include "battery.h"
+
+#include <avr/io.h>
+
+#include "clock.h"
+
+static uint8_t _battery_low = 0;
+
+static uint16_t _battery_convert(void)
+{
+	ADCSRA |= (1 << ADSC);
+	while (ADCSRA & (1 << ADSC));
+	return ADC;
+}
+
+// returns Vcc in mV, the ADC is switched off afterwards
+uint16_t battery_read_mv(void)
+{
+	uint16_t adc;
+
+	ADMUX = (1 << MUX3) | (1 << MUX2); // Vcc as reference, bandgap as input
+	ADCSRA = (1 << ADEN) | (1 << ADPS1) | (1 << ADPS0); // 125kHz ADC clock at 1MHz
+	clock_idle_ms(1); // bandgap start-up time
+	_battery_convert(); // first conversion after switching the input is inaccurate
+	adc = _battery_convert();
+	ADCSRA = 0;
+
+	if (!adc) return 0;
+	return ((uint32_t)BATTERY_BANDGAP_MV * 1024) / adc;
+}
+
+// compare against the threshold, once low the voltage has to rise
+// BATTERY_HYSTERESIS_MV above it to be ok again
+uint8_t battery_ok(uint16_t mv, uint16_t threshold_mv)
+{
+	if (_battery_low) {
+		threshold_mv += BATTERY_HYSTERESIS_MV;
+	}
+	_battery_low = (mv < threshold_mv);
+	return !_battery_low;
+}
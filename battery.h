@@ -0,0 +1,22 @@
+/*
+ * battery.h
+ *
+ * Supply voltage measurement with the internal 1.1V bandgap.
+ *
+ * The ADC measures the bandgap against Vcc as reference, so
+ * Vcc = 1.1V * 1024 / ADC. Accuracy is limited by the bandgap tolerance
+ * (1.0V to 1.2V), calibrate BATTERY_BANDGAP_MV per chip if needed.
+ */
+
+#ifndef BATTERY_H_
+#define BATTERY_H_
+
+#include <stdint.h>
+
+#define BATTERY_BANDGAP_MV		1100
+#define BATTERY_HYSTERESIS_MV	100	// voltage above the threshold to leave the low state
+
+uint16_t battery_read_mv(void);
+uint8_t battery_ok(uint16_t mv, uint16_t threshold_mv);
+
+#endif /* BATTERY_H_ */
@@ -0,0 +1,84 @@
+/*
+ * clock.c
+ *
+ * System clock prescaler management.
+ */
+
+#include "clock.h"
+
+#include <avr/io.h>
+#include <avr/power.h>
+#include <util/delay_basic.h>
+
+static uint8_t _clock_base = 0;		// CLKPS at F_CPU, set by the CKDIV8 fuse
+static int8_t _clock_shift = 0;		// current division relative to F_CPU
+
+void clock_init(void)
+{
+	_clock_base = CLKPR & 0x0F;
+	_clock_shift = 0;
+}
+
+// the timed CLKPCE/CLKPS sequence in inline asm, interrupts off meanwhile
+static inline void _clock_set(uint8_t clkps)
+{
+	clock_prescale_set((clock_div_t)clkps);
+	_clock_shift = clkps - _clock_base;
+}
+
+// run at F_CPU / 2^shift, a negative shift runs faster than F_CPU
+// as far as the CKDIV8 fuse allows
+void clock_scale(int8_t shift)
+{
+	int8_t clkps = _clock_base + shift;
+	if (clkps < 0) clkps = 0;
+	if (clkps > 8) clkps = 8;
+
+	_clock_set(clkps);
+}
+
+static uint32_t _clock_scaled(uint32_t loops)
+{
+	return (_clock_shift >= 0) ? loops >> _clock_shift : loops << -_clock_shift;
+}
+
+// _delay_loop_2() takes 4 cycles per iteration, 0 means 65536
+static void _clock_delay_loops(uint32_t loops)
+{
+	while (loops > 0xFFFF) {
+		_delay_loop_2(0);
+		loops -= 0x10000;
+	}
+	if (loops) {
+		_delay_loop_2(loops);
+	}
+}
+
+// busy wait, correct at every prescaler setting
+void clock_delay_ms(uint16_t ms)
+{
+	_clock_delay_loops(_clock_scaled((uint32_t)ms * (F_CPU / 4000UL)));
+}
+
+void clock_delay_us(uint16_t us)
+{
+	_clock_delay_loops(_clock_scaled((uint32_t)us * (F_CPU / 1000000UL) / 4));
+}
+
+// busy wait at the reduced clock, returns at the full clock
+// the loop count is computed before slowing down, every instruction at the
+// reduced clock costs 2^CLOCK_SLOW_SHIFT cycles, about 8 slow cycles of
+// switching back are taken off the wait
+static void _clock_idle(uint32_t loops)
+{
+	loops >>= CLOCK_SLOW_SHIFT;
+	loops = (loops > 2) ? loops - 2 : 1;
+	_clock_set(_clock_base + CLOCK_SLOW_SHIFT);
+	_clock_delay_loops(loops);
+	_clock_set(_clock_base);
+}
+
+void clock_idle_ms(uint16_t ms)
+{
+	_clock_idle((uint32_t)ms * (F_CPU / 4000UL));
+}
@@ -0,0 +1,31 @@
+/*
+ * clock.h
+ *
+ * System clock prescaler management.
+ *
+ * Long waits that do not need exact timing of single instructions are run
+ * with the clock divided by 2^CLOCK_SLOW_SHIFT, which cuts the active
+ * current accordingly. Bit-banged protocols always run at the full clock,
+ * clock_idle_ms() restores it before returning. Short interrupt driven
+ * captures may run above F_CPU with CLOCK_FAST_SHIFT.
+ *
+ * _delay_ms()/_delay_us() assume F_CPU and take 2^shift times longer at a
+ * reduced clock, use clock_delay_*() where the clock may be scaled.
+ */
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <stdint.h>
+
+#define CLOCK_SLOW_SHIFT	4	// 62.5kHz at F_CPU = 1MHz
+#define CLOCK_FAST_SHIFT	-3	// 8MHz at F_CPU = 1MHz, needs Vcc >= 2.7V
+#define CLOCK_FAST_MIN_MV	2800	// battery_read_mv() for CLOCK_FAST_SHIFT, margin for the measurement
+
+void clock_init(void);
+void clock_scale(int8_t shift);
+void clock_delay_ms(uint16_t ms);
+void clock_delay_us(uint16_t us);
+void clock_idle_ms(uint16_t ms);
+
+#endif /* CLOCK_H_ */
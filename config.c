@@ -0,0 +1,49 @@
+/*
+ * config.c
+ *
+ * Runtime configuration, read once at boot from EEPROM into RAM.
+ */
+
+#include <avr/eeprom.h>
+#include <avr/pgmspace.h>
+
+#include "config.h"
+#include "onewire.h"
+
+config_t config;
+
+static const config_t _config_default PROGMEM = CONFIG_DEFAULTS;
+
+#define CONFIG_DEFAULT(field)	memcpy_P(&config.field, &_config_default.field, sizeof(config.field))
+
+// replace fields out of range by their defaults, a CRC only proves that the
+// record was written as it is
+static void _config_check(void)
+{
+	for (uint8_t job = 0; job < CONFIG_SENSORS; job++) {
+		if (config.protocol[job] > PROTOCOL_LAST) {
+			CONFIG_DEFAULT(protocol[job]);
+		}
+		if (!CONFIG_PERIODS_OK(config.period[job], config.period_min[job], config.period_max[job])) {
+			CONFIG_DEFAULT(period[job]);
+			CONFIG_DEFAULT(period_min[job]);
+			CONFIG_DEFAULT(period_max[job]);
+		}
+	}
+	if (config.repeat_count < CONFIG_REPEAT_MIN || config.repeat_count > CONFIG_REPEAT_MAX) {
+		CONFIG_DEFAULT(repeat_count);
+	}
+	if (config.ds18b20_resolution < CONFIG_RESOLUTION_MIN || config.ds18b20_resolution > CONFIG_RESOLUTION_MAX) {
+		CONFIG_DEFAULT(ds18b20_resolution);
+	}
+}
+
+void config_load(void)
+{
+	eeprom_read_block(&config, (const void *)CONFIG_EEPROM_ADDR, sizeof(config));
+	if (config.version != CONFIG_VERSION || onewire_crc((const uint8_t *)&config, sizeof(config))) {
+		memcpy_P(&config, &_config_default, sizeof(config));
+		return;
+	}
+	_config_check();
+}
@@ -0,0 +1,80 @@
+/*
+ * config.h
+ *
+ * Runtime configuration, read once at boot from EEPROM into RAM.
+ *
+ * The record starts at CONFIG_EEPROM_ADDR and is protected by onewire_crc()
+ * over all bytes including the trailing crc. If the version or the CRC does
+ * not match (e.g. erased EEPROM), the compiled-in defaults from main.h are
+ * used. Fields out of the CONFIG_* ranges below fall back to their default
+ * one by one. Per node records are written as .eep file with host/mkconfig,
+ * which refuses out of range values.
+ *
+ * The struct is packed (-fpack-struct) and little endian, host/mkconfig
+ * must be built with the same layout. Increment CONFIG_VERSION whenever the
+ * layout changes.
+ */
+
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+#include <stdint.h>
+
+#include "main.h"
+#include "scheduler.h"
+#include "protocol.h"
+
+// EEPROM layout
+#define CONFIG_EEPROM_ADDR	0
+#define WARMUP_EEPROM_ADDR	(CONFIG_EEPROM_ADDR + sizeof(config_t))	// learned AM2302 warm-up, 1 byte
+#define PROBES_EEPROM_ADDR	(WARMUP_EEPROM_ADDR + 1)	// probe count and ROM codes, 1 + 8 * DS18X20_PROBES bytes
+
+#define CONFIG_VERSION		3
+#define CONFIG_SENSORS		SCHEDULER_JOBS	// per sensor fields are indexed by JOB_*
+
+// valid ranges
+#define CONFIG_REPEAT_MIN		1	// 0 would send nothing
+#define CONFIG_REPEAT_MAX		20
+#define CONFIG_RESOLUTION_MIN	9
+#define CONFIG_RESOLUTION_MAX	12
+#define CONFIG_PERIODS_OK(period, min, max) \
+	((min) >= 1 && (min) <= (period) && (period) <= (max) && (max) <= SCHEDULER_PERIOD_MAX)
+
+typedef struct {
+	uint8_t version;
+	uint8_t id[CONFIG_SENSORS];				// sensor IDs
+	uint8_t protocol[CONFIG_SENSORS];		// PROTOCOL_* of protocol.h
+	uint16_t period[CONFIG_SENSORS];		// reporting periods in scheduler ticks
+	uint16_t period_min[CONFIG_SENSORS];
+	uint16_t period_max[CONFIG_SENSORS];
+	uint8_t delta_temp[CONFIG_SENSORS];		// send-on-change thresholds
+	uint8_t delta_humidity[CONFIG_SENSORS];
+	uint8_t repeat_count;					// KW9010 and Nexus frame repeats
+	uint8_t ds18b20_resolution;				// 9..12 bit
+	int8_t alarm_low;						// DS18x20 comfort band in C, off if equal
+	int8_t alarm_high;
+	uint16_t battery_low_mv;
+	uint8_t crc;
+} config_t;
+
+#define CONFIG_DEFAULTS { \
+	.version = CONFIG_VERSION, \
+	.id = { [JOB_AM2302] = ID1, [JOB_DS18X20] = ID2 }, \
+	.protocol = { [JOB_AM2302] = PROTOCOL_ID1, [JOB_DS18X20] = PROTOCOL_ID2 }, \
+	.period = { [JOB_AM2302] = PERIOD_AM2302, [JOB_DS18X20] = PERIOD_DS18X20 }, \
+	.period_min = { [JOB_AM2302] = PERIOD_MIN_AM2302, [JOB_DS18X20] = PERIOD_MIN_DS18X20 }, \
+	.period_max = { [JOB_AM2302] = PERIOD_MAX_AM2302, [JOB_DS18X20] = PERIOD_MAX_DS18X20 }, \
+	.delta_temp = { [JOB_AM2302] = DELTA_TEMP_ID1, [JOB_DS18X20] = DELTA_TEMP_ID2 }, \
+	.delta_humidity = { [JOB_AM2302] = DELTA_HUMIDITY_ID1, [JOB_DS18X20] = 0 }, \
+	.repeat_count = REPEAT_COUNT, \
+	.ds18b20_resolution = DS18B20_RESOLUTION, \
+	.alarm_low = DS18X20_ALARM_LOW, \
+	.alarm_high = DS18X20_ALARM_HIGH, \
+	.battery_low_mv = BATTERY_LOW_MV, \
+}
+
+extern config_t config;
+
+void config_load(void);
+
+#endif /* CONFIG_H_ */
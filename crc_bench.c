@@ -0,0 +1,103 @@
+/*
+ * crc_bench.c
+ *
+ * Benchmark firmware for the 1-Wire CRC variants, built with make bench.
+ *
+ * Each variant checks the same 9 byte DS18B20 scratchpad. Timer0 counts
+ * the CPU cycles at CK/8 (8 cycle resolution, 2040 cycles max, 0xFFFF on
+ * overflow). The results are written to the last BENCH_SIZE bytes of the
+ * EEPROM, read them with
+ *
+ *   avrdude ... -U eeprom:r:bench.hex:i
+ *
+ * The streaming variant is measured as the CPU time of its 72 bit updates,
+ * in onewire_read_byte() these run in the slack of the read slots and do
+ * not add to the bus time. Flash and RAM of each variant are listed by
+ * make bench from the symbol table.
+ */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+#include <avr/sleep.h>
+
+#include "onewire.h"
+
+#define BENCH_NIBBLE	0
+#define BENCH_SERIAL	1
+#define BENCH_TABLE		2
+#define BENCH_STREAM	3
+#define BENCH_VARIANTS	4
+
+typedef struct {
+	uint16_t cycles[BENCH_VARIANTS];	// CPU cycles for 9 bytes
+	uint8_t crc[BENCH_VARIANTS];		// result, 0 if the variant works
+} bench_t;
+
+#define BENCH_SIZE			sizeof(bench_t)
+#define BENCH_EEPROM_ADDR	(E2END + 1 - BENCH_SIZE)
+
+// scratchpad of a DS18B20 at 25.0625 C, 12 bit, with valid CRC
+static const uint8_t _scratchpad[9] = {0x91, 0x01, 0x4B, 0x46, 0x7F, 0xFF, 0x0F, 0x10, 0x25};
+
+static void _bench_start(void)
+{
+	TCCR0A = 0;
+	TCNT0 = 0;
+	TIFR = (1 << TOV0);
+	TCCR0B = (1 << CS01); // CK/8
+}
+
+static uint16_t _bench_stop(void)
+{
+	TCCR0B = 0;
+	if (TIFR & (1 << TOV0)) {
+		return 0xFFFF;
+	}
+	return TCNT0 * 8;
+}
+
+int main(void)
+{
+	bench_t bench;
+	uint16_t overhead;
+	volatile uint8_t crc; // keeps the calls in the measured window
+
+	cli();
+	PRR &= ~(1 << PRTIM0);
+
+	_bench_start();
+	overhead = _bench_stop();
+
+	_bench_start();
+	crc = onewire_crc(_scratchpad, 9);
+	bench.cycles[BENCH_NIBBLE] = _bench_stop() - overhead;
+	bench.crc[BENCH_NIBBLE] = crc;
+
+	_bench_start();
+	crc = onewire_crc_serial(_scratchpad, 9);
+	bench.cycles[BENCH_SERIAL] = _bench_stop() - overhead;
+	bench.crc[BENCH_SERIAL] = crc;
+
+	_bench_start();
+	crc = onewire_crc_table(_scratchpad, 9);
+	bench.cycles[BENCH_TABLE] = _bench_stop() - overhead;
+	bench.crc[BENCH_TABLE] = crc;
+
+	_bench_start();
+	onewire_crc_start();
+	for (uint8_t i = 0; i < 9; i++) {
+		onewire_crc_update(_scratchpad[i]);
+	}
+	crc = onewire_crc_result();
+	bench.cycles[BENCH_STREAM] = _bench_stop() - overhead;
+	bench.crc[BENCH_STREAM] = crc;
+
+	eeprom_update_block(&bench, (void *)BENCH_EEPROM_ADDR, BENCH_SIZE);
+
+	set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+	while (1) {
+		sleep_mode();
+	}
+	return 0;
+}
@@ -21,14 +21,21 @@
 
 #include "onewire.h"
 #include "ds18x20.h"
+#include "clock.h"
 
 void ds18x20_convert_t(uint8_t parasitic_power)   {
 
     if (parasitic_power) {
+#ifdef ONEWIRE_ASYNC
+        uint8_t cmd = DS18x20_CMD_CONVERT_T;
+        onewire_write_pu_start(&cmd, 1);
+        onewire_wait();
+#else
         ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
             onewire_write_byte(DS18x20_CMD_CONVERT_T);
             ONEWIRE_STRONG_PU_ON
         }
+#endif
     } else {
         onewire_write_byte(DS18x20_CMD_CONVERT_T);       
     }
@@ -39,7 +46,7 @@ uint8_t ds18B20_read_temp(int16_t *temperature) {
     uint8_t scratchpad[9];
     
     ds18x20_read_scratchpad(scratchpad);
-    if (onewire_crc(scratchpad, 9)) {
+    if (onewire_crc_result()) {
         return ONEWIRE_CRC_ERROR;
     }
 
@@ -61,7 +68,7 @@ uint8_t ds18S20_read_temp(int16_t *temperature) {
     uint8_t scratchpad[9];
     
     ds18x20_read_scratchpad(scratchpad);
-    if (onewire_crc(scratchpad, 9)) {
+    if (onewire_crc_result()) {
         return ONEWIRE_CRC_ERROR;
     }
 
@@ -78,12 +85,18 @@ uint8_t ds18S20_read_temp(int16_t *temperature) {
 }
 
 void ds18x20_read_scratchpad(uint8_t *buffer) {
+    onewire_write_byte(DS18x20_CMD_READ_SCRATCHPAD);
+    onewire_crc_start();            // checked with onewire_crc_result()
+#ifdef ONEWIRE_ASYNC
+    onewire_read_start(buffer, 9);  // sleeps through all 72 slots
+    onewire_wait();
+#else
     uint8_t i;
 
-    onewire_write_byte(DS18x20_CMD_READ_SCRATCHPAD);
     for (i=0; i<9; i++) {
         buffer[i]=onewire_read_byte();
     }
+#endif
 }
 
 void ds18S20_write_scratchpad(int8_t tl, int8_t th) {
@@ -111,20 +124,26 @@ void ds18B20_write_scratchpad(int8_t tl, int8_t th, uint8_t adc_resolution) {
 void ds18x20_copy_scratchpad(uint8_t parasitic_power) {
 
     if (parasitic_power) {
+#ifdef ONEWIRE_ASYNC
+        uint8_t cmd = DS18x20_CMD_COPY_SCRATCHPAD;
+        onewire_write_pu_start(&cmd, 1);
+        onewire_wait();
+#else
         ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
             onewire_write_byte(DS18x20_CMD_COPY_SCRATCHPAD);
             ONEWIRE_STRONG_PU_ON
         }
+#endif
     } else {
         onewire_write_byte(DS18x20_CMD_COPY_SCRATCHPAD);
     }
-    _delay_ms(10);
+    clock_idle_ms(10);
     ONEWIRE_STRONG_PU_OFF
 }
 
 void ds18x20_recall_E2(void) {
     onewire_write_byte(DS18x20_CMD_RECALL_E2);
-    _delay_ms(1);
+    clock_idle_ms(1);
 }
 
 uint8_t ds18x20_read_power_supply(void) {
@@ -108,6 +108,7 @@ uint8_t ds18S20_read_temp(int16_t *temperature);
 
 /**
  \brief Read complete scratchpad of DS18x20 (9 bytes)
+ \brief the CRC is checked while reading, see onewire_crc_result()
  \param *buffer pointer to data array
  \return none
  */   
@@ -0,0 +1,125 @@
+/*
+ * mkconfig.c
+ *
+ * Host tool: write a runtime configuration record (config.h) as Intel HEX
+ * for the EEPROM of one node.
+ *
+ *   host/mkconfig id_am2302=0x23 id_ds18x20=0x24 > node23.eep
+ *   avrdude ... -U eeprom:w:node23.eep:i
+ *
+ * Fields not given on the command line keep the defaults from main.h.
+ * Values out of range are refused, config_load() would replace them.
+ * Build with -fpack-struct, the layout has to match the firmware.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+
+#define FIELD(name, member, min, max) { name, offsetof(config_t, member), sizeof(((config_t *)0)->member), min, max }
+
+static const struct {
+	const char *name;
+	size_t offset;
+	size_t size;
+	long min;
+	long max;
+} fields[] = {
+	FIELD("id_am2302", id[JOB_AM2302], 0, 255),
+	FIELD("id_ds18x20", id[JOB_DS18X20], 0, 255),
+	FIELD("protocol_am2302", protocol[JOB_AM2302], 0, PROTOCOL_LAST),
+	FIELD("protocol_ds18x20", protocol[JOB_DS18X20], 0, PROTOCOL_LAST),
+	FIELD("period_am2302", period[JOB_AM2302], 1, SCHEDULER_PERIOD_MAX),
+	FIELD("period_ds18x20", period[JOB_DS18X20], 1, SCHEDULER_PERIOD_MAX),
+	FIELD("period_min_am2302", period_min[JOB_AM2302], 1, SCHEDULER_PERIOD_MAX),
+	FIELD("period_min_ds18x20", period_min[JOB_DS18X20], 1, SCHEDULER_PERIOD_MAX),
+	FIELD("period_max_am2302", period_max[JOB_AM2302], 1, SCHEDULER_PERIOD_MAX),
+	FIELD("period_max_ds18x20", period_max[JOB_DS18X20], 1, SCHEDULER_PERIOD_MAX),
+	FIELD("delta_temp_am2302", delta_temp[JOB_AM2302], 0, 255),
+	FIELD("delta_temp_ds18x20", delta_temp[JOB_DS18X20], 0, 255),
+	FIELD("delta_humidity_am2302", delta_humidity[JOB_AM2302], 0, 255),
+	FIELD("repeat_count", repeat_count, CONFIG_REPEAT_MIN, CONFIG_REPEAT_MAX),
+	FIELD("ds18b20_resolution", ds18b20_resolution, CONFIG_RESOLUTION_MIN, CONFIG_RESOLUTION_MAX),
+	FIELD("alarm_low", alarm_low, -128, 127),
+	FIELD("alarm_high", alarm_high, -128, 127),
+	FIELD("battery_low_mv", battery_low_mv, 0, 65535),
+};
+
+// same CRC as onewire_crc_serial()
+static uint8_t crc8(const uint8_t *data, size_t cnt)
+{
+	uint8_t crc = 0;
+	while (cnt--) {
+		uint8_t tmp = *data++;
+		for (int i = 0; i < 8; i++) {
+			uint8_t mix = (crc ^ tmp) & 1;
+			crc >>= 1;
+			if (mix) crc ^= 0x8C;
+			tmp >>= 1;
+		}
+	}
+	return crc;
+}
+
+static void ihex_record(uint16_t addr, uint8_t type, const uint8_t *data, uint8_t len)
+{
+	uint8_t sum = len + (addr >> 8) + (addr & 0xFF) + type;
+	printf(":%02X%04X%02X", len, addr, type);
+	for (uint8_t i = 0; i < len; i++) {
+		printf("%02X", data[i]);
+		sum += data[i];
+	}
+	printf("%02X\n", (uint8_t)-sum);
+}
+
+int main(int argc, char **argv)
+{
+	config_t cfg = CONFIG_DEFAULTS;
+	uint8_t *raw = (uint8_t *)&cfg;
+
+	for (int a = 1; a < argc; a++) {
+		char *eq = strchr(argv[a], '=');
+		size_t i;
+		if (!eq) {
+			fprintf(stderr, "usage: %s [field=value ...]\n", argv[0]);
+			return 1;
+		}
+		*eq = 0;
+		for (i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+			if (!strcmp(argv[a], fields[i].name)) break;
+		}
+		if (i == sizeof(fields) / sizeof(fields[0])) {
+			fprintf(stderr, "unknown field %s\n", argv[a]);
+			return 1;
+		}
+		char *end;
+		long value = strtol(eq + 1, &end, 0);
+		if (*end || end == eq + 1 || value < fields[i].min || value > fields[i].max) {
+			fprintf(stderr, "%s=%s out of range %ld..%ld\n", argv[a], eq + 1, fields[i].min, fields[i].max);
+			return 1;
+		}
+		for (size_t b = 0; b < fields[i].size; b++) { // little endian
+			raw[fields[i].offset + b] = value >> (8 * b);
+		}
+	}
+
+	for (int job = 0; job < CONFIG_SENSORS; job++) {
+		if (!CONFIG_PERIODS_OK(cfg.period[job], cfg.period_min[job], cfg.period_max[job])) {
+			fprintf(stderr, "job %d: needs period_min <= period <= period_max\n", job);
+			return 1;
+		}
+	}
+
+	cfg.crc = crc8(raw, sizeof(cfg) - 1);
+
+	for (size_t pos = 0; pos < sizeof(cfg); pos += 16) {
+		size_t len = sizeof(cfg) - pos;
+		if (len > 16) len = 16;
+		ihex_record(CONFIG_EEPROM_ADDR + pos, 0x00, raw + pos, len);
+	}
+	ihex_record(0, 0x01, NULL, 0);
+	return 0;
+}
@@ -0,0 +1,187 @@
+/*
+ * native_decode.c
+ *
+ * Host tool: reference decoder for the native frame (native.h) and the
+ * burst frame of USE_BATCH (batch.h).
+ *
+ * Takes the frame bytes as hex, one frame per argument or per line on
+ * stdin, e.g. the codes of an rtl_433 flex decoder (short pulse 1, the
+ * 1000us sync pulse skipped):
+ *
+ *   rtl_433 -X 'n=native,m=OOK_PWM,s=250,l=500,y=1000,r=3000' ...
+ *   host/native_decode {80}aa21f15233220d7fff28
+ *
+ * A leading {bits} length as printed by rtl_433 is skipped. Prints one line
+ * per record, for a burst one per sample, oldest first, with its time in
+ * seconds before the burst. Exits with 1 if any frame was invalid.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "native.h"
+#include "batch.h"
+#include "scheduler.h"
+
+// same CRC as onewire_crc_serial()
+static uint8_t crc8(const uint8_t *data, size_t cnt)
+{
+	uint8_t crc = 0;
+	while (cnt--) {
+		uint8_t tmp = *data++;
+		for (int i = 0; i < 8; i++) {
+			uint8_t mix = (crc ^ tmp) & 1;
+			crc >>= 1;
+			if (mix) crc ^= 0x8C;
+			tmp >>= 1;
+		}
+	}
+	return crc;
+}
+
+static int hexval(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	c = tolower((unsigned char)c);
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	return -1;
+}
+
+static int batch(const uint8_t *frame, size_t len)
+{
+	int humidity = (frame[0] & BATCH_HUMIDITY) != 0;
+	size_t pos = humidity ? 7 : 5;
+	uint8_t count = (len > 2) ? frame[2] : 0;
+	int temp[256], hum[256];
+	long seconds[256];
+
+	if (!count || len < pos + 1) {
+		printf("burst too short\n");
+		return 1;
+	}
+
+	// newest first, each delta leads to the next older sample, a break
+	// carries the full older sample
+	temp[0] = (int16_t)((frame[3] << 8) | frame[4]);
+	hum[0] = humidity ? (frame[5] << 8) | frame[6] : 0;
+	seconds[0] = 0;
+	for (uint8_t n = 1; n < count; n++) {
+		if (pos + 3 > len) {
+			printf("burst too short\n");
+			return 1;
+		}
+		seconds[n] = seconds[n - 1] - ((frame[pos] << 8) | frame[pos + 1]) * (long)(SCHEDULER_TICK_MS / 1000);
+		pos += 2;
+		if ((int8_t)frame[pos] == BATCH_BREAK) {
+			pos++;
+			if (pos + (humidity ? 4 : 2) > len) {
+				printf("burst too short\n");
+				return 1;
+			}
+			temp[n] = (int16_t)((frame[pos] << 8) | frame[pos + 1]);
+			pos += 2;
+			if (humidity) {
+				hum[n] = (frame[pos] << 8) | frame[pos + 1];
+				pos += 2;
+			}
+		} else {
+			temp[n] = temp[n - 1] - (int8_t)frame[pos++];
+			if (humidity) {
+				if (pos >= len) {
+					printf("burst too short\n");
+					return 1;
+				}
+				hum[n] = hum[n - 1] - (int8_t)frame[pos++];
+			}
+		}
+		if (!humidity) {
+			hum[n] = 0;
+		}
+	}
+	if (pos + 1 > len || crc8(frame, pos + 1)) {
+		printf("crc error\n");
+		return 1;
+	}
+
+	for (int n = count - 1; n >= 0; n--) {
+		printf("id 0x%02X battery %s t %lds temperature %.1f C", frame[1], (frame[0] & 0x08) ? "ok" : "low", seconds[n], temp[n] / 10.0);
+		if (humidity) {
+			printf(" humidity %.1f %%", hum[n] / 10.0);
+		}
+		printf("\n");
+	}
+	return 0;
+}
+
+// returns 0 if the frame was valid
+static int decode(const char *text)
+{
+	uint8_t frame[256];
+	size_t len = 0;
+	int hi = -1;
+
+	if (*text == '{') {
+		text = strchr(text, '}');
+		if (!text) return 1;
+		text++;
+	}
+	for (; *text && len < sizeof(frame); text++) {
+		int v = hexval(*text);
+		if (v < 0) continue;
+		if (hi < 0) {
+			hi = v;
+		} else {
+			frame[len++] = (hi << 4) | v;
+			hi = -1;
+		}
+	}
+	if (len >= 2 && (frame[0] & 0xF0) == BATCH_MAGIC) {
+		return batch(frame, len);
+	}
+	if (len < 2 || (frame[0] & 0xF0) != NATIVE_MAGIC) {
+		printf("no native frame\n");
+		return 1;
+	}
+
+	uint8_t count = frame[0] & 0x07;
+	if (len < NATIVE_BYTES(count)) {
+		printf("frame too short for %u records\n", count);
+		return 1;
+	}
+	if (crc8(frame, NATIVE_BYTES(count))) {
+		printf("crc error\n");
+		return 1;
+	}
+
+	for (uint8_t i = 0; i < count; i++) {
+		const uint8_t *r = &frame[1 + i * NATIVE_RECORD_BYTES];
+		int temp = (r[1] << 4) | (r[2] >> 4);
+		int humidity = ((r[2] & 0x0F) << 8) | r[3];
+
+		if (temp & 0x800) temp -= 0x1000; // 12 bit two's complement
+		printf("id 0x%02X battery %s temperature %.1f C", r[0], (frame[0] & 0x08) ? "ok" : "low", temp / 10.0);
+		if (humidity != NATIVE_NO_HUMIDITY) {
+			printf(" humidity %.1f %%", humidity / 10.0);
+		}
+		printf("\n");
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	char line[1024];
+	int error = 0;
+
+	if (argc > 1) {
+		for (int a = 1; a < argc; a++) {
+			error |= decode(argv[a]);
+		}
+		return error;
+	}
+	while (fgets(line, sizeof(line), stdin)) {
+		error |= decode(line);
+	}
+	return error;
+}
@@ -0,0 +1,403 @@
+/*
+ * onewire_sim.c
+ *
+ * Host tool: onewire.c and ds18x20.c against a simulated 1-Wire bus.
+ *
+ *   make host && host/onewire_sim [seed]
+ *
+ * The bus macros of onewire.h call onewire_sim_low/release/read() with
+ * ONEWIRE_SIM, _delay_us() advances the simulated time (host/sim/). The
+ * virtual devices decode the slots from the low time like a DS18B20:
+ * reset (>= 480us), write 0 (>= 15us), write 1 or read (< 15us).
+ *
+ * For 1, 8, 32 and 100 devices with random ROM codes (and a batch with
+ * consecutive serial numbers) it checks that onewire_search_rom() and
+ * onewire_alarm_search() find every device exactly once, that every
+ * scratchpad reads back by match ROM and that CRC faults are detected. It
+ * reports the bit slots and the simulated bus time of each search.
+ * Exit code 1 on any failure.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "onewire.h"
+#include "ds18x20.h"
+#include "clock.h"
+
+#define SIM_DEVICES_MAX	128
+
+// receive/transmit state of a virtual device
+enum sim_state {
+	SIM_IDLE,		// not selected, waits for reset
+	SIM_ROM_CMD,	// receives the ROM command
+	SIM_SEARCH,		// ROM search: bit, complement, master bit
+	SIM_MATCH,		// receives the ROM code
+	SIM_FUNC_CMD,	// selected, receives the function command
+	SIM_TX			// sends tx[]
+};
+
+typedef struct {
+	uint8_t rom[8];
+	uint8_t scratchpad[9];
+	int16_t temp;			// 1/16 C
+	uint8_t alarm;			// alarm flag for the alarm search
+	uint8_t crc_fault;		// scratchpad is sent with a flipped bit
+	uint8_t state;
+	uint8_t rx;				// receive shift register
+	uint8_t rx_bits;
+	uint8_t pos;			// bit position in ROM or tx[]
+	uint8_t phase;			// SIM_SEARCH: 0 bit, 1 complement, 2 master bit
+	uint8_t tx[9];
+	uint8_t tx_bits;
+	uint8_t drive;			// pulls the bus low in the current slot
+} sim_dev_t;
+
+volatile uint8_t PORTB, DDRB, PINB;
+
+static sim_dev_t _dev[SIM_DEVICES_MAX];
+static int _devices;
+
+static double _now;			// simulated time in us
+static double _low_at;		// start of the current low pulse
+static double _reset_at;	// release of the last reset pulse
+static int _low;			// master pulls low
+static long _slots;
+static long _resets;
+
+void onewire_sim_delay_us(double us)
+{
+	_now += us;
+}
+
+void clock_idle_ms(uint16_t ms)
+{
+	_now += ms * 1000.0;
+}
+
+static uint8_t _bit(const uint8_t *data, uint8_t pos)
+{
+	return (data[pos >> 3] >> (pos & 7)) & 1;
+}
+
+static uint8_t _crc8(const uint8_t *data, int cnt)
+{
+	uint8_t crc = 0;
+	while (cnt--) {
+		uint8_t tmp = *data++;
+		for (int i = 0; i < 8; i++) {
+			uint8_t mix = (crc ^ tmp) & 1;
+			crc >>= 1;
+			if (mix) crc ^= 0x8C;
+			tmp >>= 1;
+		}
+	}
+	return crc;
+}
+
+static void _tx(sim_dev_t *d, const uint8_t *data, int len)
+{
+	memcpy(d->tx, data, len);
+	d->tx_bits = len * 8;
+	d->pos = 0;
+	d->state = SIM_TX;
+}
+
+// bit the device sends in the coming slot, -1 if it listens
+static int _dev_out(sim_dev_t *d)
+{
+	if (d->state == SIM_SEARCH && d->phase < 2) {
+		return _bit(d->rom, d->pos) ^ d->phase;
+	}
+	if (d->state == SIM_TX) {
+		return _bit(d->tx, d->pos);
+	}
+	return -1;
+}
+
+static void _dev_function(sim_dev_t *d, uint8_t cmd)
+{
+	uint8_t buf[9];
+
+	switch (cmd) {
+	case DS18x20_CMD_CONVERT_T:
+		d->scratchpad[0] = d->temp & 0xFF;
+		d->scratchpad[1] = d->temp >> 8;
+		d->scratchpad[8] = _crc8(d->scratchpad, 8);
+		d->state = SIM_IDLE; // read slots return 1: conversion done
+		break;
+	case DS18x20_CMD_READ_SCRATCHPAD:
+		memcpy(buf, d->scratchpad, 9);
+		if (d->crc_fault) {
+			buf[0] ^= 0x04;
+		}
+		_tx(d, buf, 9);
+		break;
+	case DS18x20_CMD_READ_POWER_SUPPLY:
+		buf[0] = 0xFF; // external power
+		_tx(d, buf, 1);
+		break;
+	default:
+		d->state = SIM_IDLE;
+		break;
+	}
+}
+
+// the master released the bus after a slot, bit is the written value
+static void _dev_slot(sim_dev_t *d, uint8_t bit)
+{
+	switch (d->state) {
+	case SIM_ROM_CMD:
+	case SIM_FUNC_CMD:
+		d->rx = (d->rx >> 1) | (bit << 7);
+		if (++d->rx_bits < 8) {
+			break;
+		}
+		d->rx_bits = 0;
+		if (d->state == SIM_FUNC_CMD) {
+			_dev_function(d, d->rx);
+			break;
+		}
+		d->pos = 0;
+		d->phase = 0;
+		switch (d->rx) {
+		case ONEWIRE_SEARCH_ROM: d->state = SIM_SEARCH; break;
+		case ONEWIRE_ALARM_SEARCH: d->state = d->alarm ? SIM_SEARCH : SIM_IDLE; break;
+		case ONEWIRE_MATCH_ROM: d->state = SIM_MATCH; break;
+		case ONEWIRE_SKIP_ROM: d->state = SIM_FUNC_CMD; break;
+		case ONEWIRE_READ_ROM: _tx(d, d->rom, 8); break;
+		default: d->state = SIM_IDLE; break;
+		}
+		break;
+
+	case SIM_SEARCH:
+		if (d->phase < 2) {
+			d->phase++;
+			break;
+		}
+		d->phase = 0;
+		// no break
+	case SIM_MATCH:
+		if (bit != _bit(d->rom, d->pos)) {
+			d->state = SIM_IDLE; // deselected
+		} else if (++d->pos == 64) {
+			d->state = SIM_FUNC_CMD;
+		}
+		break;
+
+	case SIM_TX:
+		if (++d->pos == d->tx_bits) {
+			d->state = SIM_IDLE;
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void onewire_sim_low(void)
+{
+	if (_low) {
+		return;
+	}
+	_low = 1;
+	_low_at = _now;
+	for (int i = 0; i < _devices; i++) {
+		_dev[i].drive = (_dev_out(&_dev[i]) == 0);
+	}
+}
+
+void onewire_sim_release(void)
+{
+	if (!_low) {
+		return;
+	}
+	_low = 0;
+	double t = _now - _low_at;
+
+	if (t >= 480) {
+		_resets++;
+		_reset_at = _now;
+		for (int i = 0; i < _devices; i++) {
+			_dev[i].state = SIM_ROM_CMD;
+			_dev[i].rx_bits = 0;
+			_dev[i].drive = 0;
+		}
+		return;
+	}
+	_slots++;
+	for (int i = 0; i < _devices; i++) {
+		_dev_slot(&_dev[i], t < 15);
+	}
+}
+
+uint8_t onewire_sim_read(void)
+{
+	if (_low) {
+		return 0;
+	}
+	double since_reset = _now - _reset_at;
+	if (_devices && since_reset >= 15 && since_reset < 240) {
+		return 0; // presence pulse
+	}
+	if (_now - _low_at < 45) {
+		for (int i = 0; i < _devices; i++) {
+			if (_dev[i].drive) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+// random DS18B20 with valid ROM CRC, serial > 0 gives consecutive numbers
+static void _dev_init(sim_dev_t *d, long serial)
+{
+	memset(d, 0, sizeof(*d));
+	d->rom[0] = DS18B20_ID;
+	for (int b = 1; b < 7; b++) {
+		d->rom[b] = serial ? (serial >> (8 * (b - 1))) & 0xFF : rand() & 0xFF;
+	}
+	d->rom[7] = _crc8(d->rom, 7);
+
+	static const uint8_t pad[9] = {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0x00};
+	memcpy(d->scratchpad, pad, 9);
+	d->temp = (rand() % 1600) - 400; // -25..75 C
+	d->alarm = (rand() % 4) == 0;
+	d->crc_fault = (rand() % 8) == 0;
+}
+
+static int _devices_unique(void)
+{
+	for (int i = 0; i < _devices; i++) {
+		for (int j = 0; j < i; j++) {
+			if (!memcmp(_dev[i].rom, _dev[j].rom, 8)) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+static int _find(const uint8_t rom[8])
+{
+	for (int i = 0; i < _devices; i++) {
+		if (!memcmp(_dev[i].rom, rom, 8)) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// enumerate with search or alarm search, 0 if every expected device was
+// found exactly once
+static int _enumerate(uint8_t alarm, long *slots, double *us)
+{
+	uint8_t rom[8];
+	int seen[SIM_DEVICES_MAX] = {0};
+	int expected = 0, found = 0;
+	uint8_t rc;
+	int errors = 0;
+
+	_slots = 0;
+	_now = 0;
+	onewire_search_init(rom);
+	do {
+		rc = alarm ? onewire_alarm_search(rom) : onewire_search_rom(rom);
+		if (rc == ONEWIRE_SCAN_ERROR && alarm && !found) {
+			break; // no device in alarm
+		}
+		if (rc != ONEWIRE_OK && rc != ONEWIRE_LAST_CODE) {
+			printf("    %s search: error %d after %d devices\n", alarm ? "alarm" : "rom", rc, found);
+			return 1;
+		}
+		int i = _find(rom);
+		if (i < 0) {
+			printf("    unknown ROM code\n");
+			errors++;
+		} else {
+			seen[i]++;
+			found++;
+		}
+	} while (rc == ONEWIRE_OK && found <= _devices);
+
+	for (int i = 0; i < _devices; i++) {
+		int want = alarm ? _dev[i].alarm : 1;
+		expected += want;
+		if (seen[i] != want) {
+			printf("    device %d found %d times, expected %d\n", i, seen[i], want);
+			errors++;
+		}
+	}
+	if (found != expected) {
+		errors++;
+	}
+	*slots = _slots;
+	*us = _now;
+	return errors;
+}
+
+// convert, then read every device by match ROM
+static int _read_all(void)
+{
+	int errors = 0;
+
+	onewire_skip_rom();
+	ds18B20_convert_t(0);
+	for (int i = 0; i < _devices; i++) {
+		int16_t temp;
+		onewire_match_rom(_dev[i].rom);
+		uint8_t rc = ds18B20_read_temp(&temp);
+		int16_t want = (_dev[i].temp * 10) >> 4;
+		if (_dev[i].crc_fault ? rc != ONEWIRE_CRC_ERROR : (rc || temp != want)) {
+			printf("    device %d: rc %d temp %d, expected %d\n", i, rc, temp, want);
+			errors++;
+		}
+	}
+	return errors;
+}
+
+static int _run(int devices, int consecutive)
+{
+	long slots, alarm_slots;
+	double us, alarm_us;
+	int alarms = 0;
+	int errors;
+
+	do {
+		_devices = devices;
+		long base = consecutive ? (rand() & 0xFFFF) * 0x10000L + 1 : 0;
+		for (int i = 0; i < devices; i++) {
+			_dev_init(&_dev[i], consecutive ? base + i : 0);
+		}
+	} while (!_devices_unique());
+	for (int i = 0; i < devices; i++) {
+		alarms += _dev[i].alarm;
+	}
+
+	errors = _enumerate(0, &slots, &us);
+	errors += _enumerate(1, &alarm_slots, &alarm_us);
+	errors += _read_all();
+
+	printf("%4d %-11s %8ld %9.1f %8d %8ld %9.1f  %s\n", devices,
+		consecutive ? "consecutive" : "random", slots, us / 1000.0,
+		alarms, alarm_slots, alarm_us / 1000.0, errors ? "FAIL" : "ok");
+	return errors;
+}
+
+int main(int argc, char **argv)
+{
+	static const int sizes[] = {1, 8, 32, 100};
+	int errors = 0;
+
+	srand(argc > 1 ? atoi(argv[1]) : 1);
+
+	printf("devs ROM codes      search slots  time ms   alarms  alarm slots  time ms\n");
+	for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		errors += _run(sizes[s], 0);
+		errors += _run(sizes[s], 1);
+	}
+	return errors ? 1 : 0;
+}
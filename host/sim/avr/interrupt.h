@@ -0,0 +1,7 @@
+#ifndef SIM_AVR_INTERRUPT_H_
+#define SIM_AVR_INTERRUPT_H_
+
+#define sei()
+#define cli()
+
+#endif /* SIM_AVR_INTERRUPT_H_ */
@@ -0,0 +1,21 @@
+/*
+ * avr/io.h for the host build of onewire.c (host/onewire_sim.c)
+ *
+ * Only what onewire.h needs, the bus itself is simulated (ONEWIRE_SIM).
+ */
+
+#ifndef SIM_AVR_IO_H_
+#define SIM_AVR_IO_H_
+
+#include <stdint.h>
+
+extern volatile uint8_t PORTB, DDRB, PINB;
+
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+
+#endif /* SIM_AVR_IO_H_ */
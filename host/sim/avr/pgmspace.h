@@ -0,0 +1,7 @@
+#ifndef SIM_AVR_PGMSPACE_H_
+#define SIM_AVR_PGMSPACE_H_
+
+#define PROGMEM
+#define pgm_read_byte(addr)	(*(const uint8_t *)(addr))
+
+#endif /* SIM_AVR_PGMSPACE_H_ */
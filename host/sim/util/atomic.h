@@ -0,0 +1,7 @@
+#ifndef SIM_UTIL_ATOMIC_H_
+#define SIM_UTIL_ATOMIC_H_
+
+#define ATOMIC_RESTORESTATE	0
+#define ATOMIC_BLOCK(type)	for (int _atomic = 1; _atomic; _atomic = 0)
+
+#endif /* SIM_UTIL_ATOMIC_H_ */
@@ -0,0 +1,13 @@
+/*
+ * util/delay.h for the host build, delays advance the simulated bus time
+ */
+
+#ifndef SIM_UTIL_DELAY_H_
+#define SIM_UTIL_DELAY_H_
+
+void onewire_sim_delay_us(double us);
+
+#define _delay_us(us)	onewire_sim_delay_us(us)
+#define _delay_ms(ms)	onewire_sim_delay_us((ms) * 1000.0)
+
+#endif /* SIM_UTIL_DELAY_H_ */
@@ -0,0 +1,57 @@
+/*
+ * jitter.c
+ *
+ * Transmit time dithering.
+ */
+
+#include "jitter.h"
+#include "watchdog.h"
+
+static uint16_t _jitter_state = 1;
+
+void jitter_init(uint16_t seed)
+{
+	_jitter_state = seed ? seed : 1; // 0 is a fixed point
+	for (uint8_t i = 0; i < 8; i++) { // spread seeds that differ in few bits
+		jitter_random();
+	}
+}
+
+// xorshift 7, 9, 8, period 65535
+uint16_t jitter_random(void)
+{
+	uint16_t x = _jitter_state;
+
+	x ^= x << 7;
+	x ^= x >> 9;
+	x ^= x << 8;
+	_jitter_state = x;
+	return x;
+}
+
+// offset in ticks for the next deadline of a job with this period,
+// symmetric so the mean period stays the nominal one
+int8_t jitter_ticks(uint16_t period)
+{
+	uint16_t bound = (period - 1) / 2;
+
+	if (bound > JITTER_TICKS) {
+		bound = JITTER_TICKS;
+	}
+	if (!period || !bound) {
+		return 0;
+	}
+	return (int8_t)(jitter_random() % (2 * bound + 1)) - (int8_t)bound;
+}
+
+// random nap between two frames, returns the ms slept
+uint16_t jitter_nap(void)
+{
+	uint16_t ms = JITTER_GAP_MIN_MS + (jitter_random() % JITTER_GAP_STEPS) * WATCHDOG_PERIOD_MS(0);
+	uint16_t slept = 0;
+
+	while (slept < ms) {
+		slept += watchdog_nap_ms(ms - slept);
+	}
+	return slept;
+}
@@ -0,0 +1,28 @@
+/*
+ * jitter.h
+ *
+ * Transmit time dithering, so nodes that happen to wake up together do not
+ * collide every cycle.
+ *
+ * A 16 bit xorshift generator, seeded from the sensor IDs and the measured
+ * watchdog period (which differs from chip to chip), gives every node its
+ * own sequence. The scheduler moves each deadline by up to JITTER_TICKS
+ * around its nominal time, drawn anew every cycle, and frames sent in the
+ * same cycle are separated by a random nap.
+ */
+
+#ifndef JITTER_H_
+#define JITTER_H_
+
+#include <stdint.h>
+
+#define JITTER_TICKS		3	// max. deadline offset in scheduler ticks, at most (period - 1) / 2
+#define JITTER_GAP_MIN_MS	64	// nap between two frames of a cycle
+#define JITTER_GAP_STEPS	32	// plus 0..31 steps of 16ms
+
+void jitter_init(uint16_t seed);
+uint16_t jitter_random(void);
+int8_t jitter_ticks(uint16_t period);
+uint16_t jitter_nap(void);
+
+#endif /* JITTER_H_ */
@@ -17,25 +17,29 @@
   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
-#include "kw9010.h"
-
-#include <util/delay.h>
+#include <avr/pgmspace.h>
 
-#define KW9010_data_out		DDR_KW9010 |= (1 << KW9010)
-#define KW9010_data_in		DDR_KW9010 &= ~(1 << KW9010)
-#define KW9010_data_high	PORT_KW9010 |= (1 << KW9010)
-#define KW9010_data_low		PORT_KW9010 &= ~(1 << KW9010)
-#define KW9010_is_high		PIN_KW9010 & (1 << KW9010)
-#define KW9010_is_low		!(PIN_KW9010 & (1 << KW9010))
+#include "kw9010.h"
+#include "radio.h"
 
 #define bitRead(value, bit) (((value) >> (bit)) & 0x01)
 #define bitSet(value, bit) ((value) |= (1UL << (bit)))
 #define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
 #define bitWrite(value, bit, bitvalue) (bitvalue ? bitSet(value, bit) : bitClear(value, bit))
 
-void kw9010_init(void)
+static uint8_t _repeatCount = 3;
+
+static const radio_protocol_t _kw9010_protocol PROGMEM = {
+	.sync = { RADIO_HIGH(_timeSync) },
+	.zero = { RADIO_LOW(_timeDummy), RADIO_HIGH(_timeZero) },
+	.one = { RADIO_LOW(_timeDummy), RADIO_HIGH(_timeOne) },
+	.gap = { 0 },
+	.flags = RADIO_INVERT_ODD,
+};
+
+void kw9010_init(uint8_t repeatCount)
 {
-	return;
+	_repeatCount = repeatCount;
 }
 
 uint8_t _kw9010_generateInternalID(uint8_t id, uint8_t channel) {
@@ -70,63 +74,11 @@ uint8_t _kw9010_generateChecksum(uint8_t data[], uint8_t numBits) {
 	return invSum;
 }
 
-void _kw9010_sendSync(void) {
-	if( _state )
-		KW9010_data_low;
-	else
-		KW9010_data_high;
-	_delay_us(_timeSync);
-	_state = ! _state;
-}
-
-void _kw9010_send0(void) {
-	// no need to change state as we would toggle twice
-	if( _state )
-		KW9010_data_low;
-	else
-		KW9010_data_high;
-	_delay_us(_timeDummy);
-	if( _state )
-		KW9010_data_high;
-	else
-		KW9010_data_low;
-	_delay_us(_timeZero);
-}
-
-void _kw9010_send1(void) {
-	// no need to change state as we would toggle twice
-	if( _state )
-		KW9010_data_low;
-	else
-		KW9010_data_high;
-	_delay_us(_timeDummy);
-	if( _state )
-		KW9010_data_high;
-	else
-		KW9010_data_low;
-	_delay_us(_timeOne);
-}
-
 void _kw9010_sendRaw(uint8_t data[], uint8_t numBits) {
-	_state = 0;
-	KW9010_data_low;
-	// no buffering, saves some RAM
-	// hopefully fast enough
-	for(uint8_t count = 0; count < _repeatCount; count++) {
-		uint8_t curChar = 0;
-		uint8_t bitHelper = 128;
-		_kw9010_sendSync();
-		for(uint8_t curBit = 0; curBit < numBits; curBit++) {
-			((data[curChar] & bitHelper) == 0) ? _kw9010_send0() : _kw9010_send1();
-			bitHelper = bitHelper >> 1;
-			if(bitHelper <= 0) {
-				bitHelper = 128;
-				curChar++;
-			}
-		}
-	}
-	_state = 0;
-	KW9010_data_low;
+	// the pin toggles at every phase, the 73 phases of a repeat are odd,
+	// so every second repeat is inverted
+	radio_send(&_kw9010_protocol, data, numBits, _repeatCount);
+	radio_wait();
 }
 
 void kw9010_send(int16_t temperature, uint8_t humidity, uint8_t battery_ok, uint8_t id, uint8_t channel) {
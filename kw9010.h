@@ -31,18 +31,15 @@
 #define	_timeZero 2000
 #define	_timeOne 4000
 #define	_timeDummy 1000
-#define _repeatCount 3
 
-void kw9010_init(void);
-void kw9010_send(int16_t temperature, uint8_t humidity, uint8_t battery_ok, uint8_t id, uint8_t channel);
+// shortest time in ms a kw9010_send() keeps the transmitter busy (all bits 0)
+#define KW9010_AIRTIME_MS(repeatCount) ((_timeSync + 36UL * (_timeDummy + _timeZero)) * (repeatCount) / 1000)
 
-uint8_t _state;
+void kw9010_init(uint8_t repeatCount);
+void kw9010_send(int16_t temperature, uint8_t humidity, uint8_t battery_ok, uint8_t id, uint8_t channel);
 
 void _kw9010_sendRaw(uint8_t data[], uint8_t numBits);
 uint8_t _kw9010_generateInternalID(uint8_t id, uint8_t channel);
 uint8_t _kw9010_generateChecksum(uint8_t data[], uint8_t numBits);
-void _kw9010_sendSync(void);
-void _kw9010_send0(void);
-void _kw9010_send1(void);
 
 #endif /* KW9010_H_ */
@@ -2,11 +2,11 @@
  * ATTINY85 Pins:
  * 1     RESET
  * 2 PB3 *_VCC
- * 3 PB4 AM2302_DATA
+ * 3 PB4 AM2302_DATA (DS18B20_DATA with USE_SHT3X)
  * 4     GND
- * 5 PB0 
+ * 5 PB0 SHT3X_SDA
  * 6 PB1 KW9010_DATA
- * 7 PB2 DS18B20_DATA
+ * 7 PB2 DS18B20_DATA, up to DS18X20_PROBES (SHT3X_SCL with USE_SHT3X)
  * 8     VCC
  * 
  * Strom-Messung:
@@ -30,6 +30,8 @@
  * FS1000A: 2s 10uA, 1s 6000uA ( (12000+0)/2 )
  * (2000+2000+50+1080+4+4+10+10+6000)/3 = 3719uA * 3s + 1900uA (ATTINY)
  * 
+ * SHT3x:   15ms 800uA instead of the 2s AM2302 warm-up
+ * 
  */
 
 
@@ -42,11 +44,27 @@
 #ifdef USE_DS18X20
 #include "onewire.h"
 #include "ds18x20.h"
+#include "probes.h"
 #endif
 
+#ifdef USE_SHT3X
+#include "sht3x.h"
+#else
 #include "am2302.h"
+#endif
 #include "kw9010.h"
+#include "protocol.h"
+#include "native.h"
+#include "batch.h"
+#include "jitter.h"
 #include "watchdog.h"
+#include "scheduler.h"
+#include "report.h"
+#include "battery.h"
+#include "config.h"
+#include "warmup.h"
+#include "clock.h"
+#include "power.h"
 
 uint8_t tmpDDR = 0;
 uint8_t tmpPORT = 0;
@@ -62,59 +80,265 @@ inline void vcc_on(void) {
 inline void vcc_off(void) {
 	tmpDDR = DDRB;
 	tmpPORT = PORTB;
-	DDRB = 0;
-	PORTB = 0;
+	DDRB = (1 << KW9010); // FS1000A data low: 0uA instead of 10uA open
+	PORTB = PINS_UNUSED; // pull-ups, unused inputs must not float
 	PORT_VCC &= ~(1 << PIN_VCC);
 	DDR_VCC &= ~(1 << PIN_VCC); //input
 }
 
-int main(void)
+#ifdef USE_SHT3X
+#define HUMIDITY_WARMUP_MS	SHT3X_WARMUP_MS
+#else
+#define HUMIDITY_WARMUP_MS	warmup_ms()
+#endif
+
+#define TICKS_PER_HOUR (3600/8)
+
+int16_t last_temp[REPORT_SLOTS];
+uint16_t last_humidity[REPORT_SLOTS];
+uint8_t last_valid = 0;
+
+// rate of change of a sensor's readings per hour from the previous reading
+// of the same report slot, the job gives the time between the readings
+// (its period as scheduled, stretched while the battery is low)
+// returns > 0 if it moves fast, < 0 if it is flat and 0 in between
+int8_t trend(uint8_t job, uint8_t slot, int16_t temp, uint16_t humidity)
 {
-	tmpDDR = DDRB;
-	tmpPORT = PORTB;
-	watchdog_init(9);
-	am2302_init();
-	kw9010_init();
+	int8_t result = 0;
+	uint16_t period = scheduler_period(job);
 
- 	sei();
+	if (last_valid & (1 << slot)) {
+		uint16_t dt = (temp > last_temp[slot]) ? temp - last_temp[slot] : last_temp[slot] - temp;
+		uint16_t dh = (humidity > last_humidity[slot]) ? humidity - last_humidity[slot] : last_humidity[slot] - humidity;
+		uint32_t rate_temp = (uint32_t)dt * TICKS_PER_HOUR / period;
+		uint32_t rate_humidity = (uint32_t)dh * TICKS_PER_HOUR / period;
 
-	while(1)
+		if (rate_temp >= SLOPE_FAST_TEMP || rate_humidity >= SLOPE_FAST_HUMIDITY) {
+			result = 1;
+		} else if (rate_temp < SLOPE_FLAT_TEMP && rate_humidity < SLOPE_FLAT_HUMIDITY) {
+			result = -1;
+		}
+	}
+	last_temp[slot] = temp;
+	last_humidity[slot] = humidity;
+	last_valid |= (1 << slot);
+	return result;
+}
+
+enum measure_state {
+	MEASURE_POWER_UP,	// switch the sensors on, start the DS18B20 conversion
+	MEASURE_DS18X20,	// conversion done, read and send each DS18B20 probe
+	MEASURE_AM2302,		// warm-up done, read and send the AM2302 or SHT3x
+	MEASURE_POWER_DOWN,	// switch the sensors off
+	MEASURE_DONE
+};
+
+// one measurement cycle for the due jobs (bitmask of JOB_*)
+// the DS18B20 converts while the AM2302 warms up, every wait between the
+// phases is spent in power down sleep instead of _delay_ms()
+// returns the ms spent awake
+uint16_t measure(uint8_t jobs)
+{
+	enum measure_state state = MEASURE_POWER_UP;
+	uint16_t awake = 0; // ms since vcc_on()
+	uint16_t ready = 0; // the current state runs not before this time
+#ifdef USE_DS18X20
+	uint16_t timeout = 0; // the DS18X20 conversion is done at the latest
+#endif
+	uint8_t error;
+	uint8_t bat_ok = 1;
+	uint16_t vcc_mv = 0;
+#ifndef USE_SHT3X
+	uint8_t retries = 0; // am2302 reads retried after a warm-up error
+#endif
+
+	while (state != MEASURE_DONE)
 	{
-		vcc_on();
-		uint8_t error;
-		
+		if (awake < ready) {
+			awake += watchdog_nap_ms(ready - awake);
+			continue;
+		}
+
+		switch (state)
+		{
+		case MEASURE_POWER_UP:
+			vcc_on();
+			report_cycle();
+			// measured with the sensors switched on, a dying cell shows up under load
+			vcc_mv = battery_read_mv();
+			bat_ok = battery_ok(vcc_mv, config.battery_low_mv);
+			scheduler_stretch(bat_ok ? 0 : BATTERY_LOW_STRETCH);
+#ifdef USE_DS18X20
+			if (jobs & (1 << JOB_DS18X20)) {
+				probes_check(); // ROM search if the bus changed
+			}
+			if (jobs & (1 << JOB_DS18X20) && probes_count) {
+				onewire_skip_rom(); // all probes convert at once
+				// parasitic probes: the strong pull-up feeds the conversion
+				// while the MCU sleeps and is released once it is done
+				ds18B20_convert_t(probes_parasitic);
+				state = MEASURE_DS18X20;
+				timeout = probes_conversion_ms();
+				ready = probes_parasitic ? timeout : timeout / 2; // start polling at half the worst case
+				break;
+			}
+#endif
+			state = MEASURE_AM2302;
+			if (jobs & (1 << JOB_AM2302)) {
+				ready = HUMIDITY_WARMUP_MS;
+			}
+			break;
+
 #ifdef USE_DS18X20
-		int16_t temp_outside;
-		onewire_skip_rom();
-		ds18B20_convert_t(0); // normal power
-		_delay_ms(750);
-		onewire_skip_rom();
-		error = ds18B20_read_temp(&temp_outside);
-		if (!error) {
-			kw9010_send(temp_outside, 0, 1, ID2, 0);
+		case MEASURE_DS18X20:
+		{
+			int8_t fastest = -1; // job trend: fast if any probe is, flat if all are
+			uint8_t read = 0;
+
+			if (awake < timeout && probes_converting()) {
+				ready = awake + PROBES_POLL_MS;
+				if (ready > timeout) {
+					ready = timeout;
+				}
+				break;
+			}
+			probes_release();
+
+			uint8_t alarmed;
+			uint8_t due = probes_due(&alarmed);
+
+			for (uint8_t probe = 0; probe < probes_count; probe++) {
+				int16_t temp_outside;
+				uint8_t slot = JOB_DS18X20 + probe;
+
+				if (!(due & (1 << probe))) {
+					continue;
+				}
+				if (alarmed & (1 << probe)) {
+					report_invalidate(slot); // outside the comfort band, send now
+				}
+				error = probes_read(probe, &temp_outside);
+				if (error) {
+					continue;
+				}
+				if (!read++) {
+					watchdog_compensate(temp_outside);
+				}
+				int8_t t = trend(JOB_DS18X20, slot, temp_outside, 0);
+				if (t > fastest) {
+					fastest = t;
+				}
+				awake += report_send(slot, temp_outside, 0, bat_ok); // transmitting counts as warm-up time
+			}
+			if (read && !probes_alarm_mode()) { // in alarm mode the period is the alarm check interval
+				scheduler_adapt(JOB_DS18X20, fastest);
+			}
+			state = MEASURE_AM2302;
+			if (jobs & (1 << JOB_AM2302)) {
+				ready = HUMIDITY_WARMUP_MS;
+			}
+			break;
 		}
-#else
-		_delay_ms(1000);
 #endif
 
-		/////////////////////////////
-		_delay_ms(1000);
-		// am2302 needs around 2 seconds init time after power on
-		// ds18b20 can be done earlier
-		uint16_t humidity = 0;
-		uint16_t temp = 0;
+		case MEASURE_AM2302:
+		{
+			if (!(jobs & (1 << JOB_AM2302))) {
+				state = MEASURE_POWER_DOWN;
+				break;
+			}
+			uint16_t humidity = 0;
+#ifdef USE_SHT3X
+			int16_t temp = 0;
+
+			error = sht3x(&humidity, &temp);
+#else
+			uint16_t temp = 0;
 
-		error = am2302(&humidity, &temp);
-		if (!error) {
-			kw9010_send(temp, humidity/10, 1, ID1, 0);
+			am2302_fast_ok(vcc_mv >= CLOCK_FAST_MIN_MV); // no 8MHz capture on a dying cell
+			error = am2302(&humidity, &temp);
+			if (error && error <= 4 && retries < WARMUP_RETRIES) {
+				// not warmed up yet, try again a step later
+				retries++;
+				ready = awake + WARMUP_STEP_MS;
+				break;
+			}
+			warmup_learn(awake, retries, error);
+			if (!error && (temp & 0x8000)) { // sign and magnitude
+				temp = -(int16_t)(temp & 0x7FFF);
+			}
+#endif
+			if (!error) {
+#ifndef USE_DS18X20
+				watchdog_compensate(temp);
+#endif
+				scheduler_adapt(JOB_AM2302, trend(JOB_AM2302, JOB_AM2302, temp, humidity));
+				awake += report_send(JOB_AM2302, temp, humidity, bat_ok);
+			}
+			state = MEASURE_POWER_DOWN;
+			break;
 		}
 
-		vcc_off();
-#ifdef DEBUGMODE 
-		watchdog_sleep(2); // 16 Sekunden
+		case MEASURE_POWER_DOWN:
+		default:
+#ifdef USE_DS18X20
+			probes_release(); // never power the bus from the pin with VCC off
+#endif
+			vcc_off();
+#ifdef USE_BATCH
+			awake += batch_send(bat_ok, config.repeat_count);
 #else
-		watchdog_sleep(10*60/8); // 10 Minuten
+			awake += native_send(bat_ok, config.repeat_count); // all readings of the cycle in one frame
 #endif
+			state = MEASURE_DONE;
+			break;
+		}
+	}
+	return awake;
+}
+
+int main(void)
+{
+	PORTB |= PINS_UNUSED;
+	tmpDDR = DDRB;
+	tmpPORT = PORTB;
+	clock_init();
+	power_init();
+	config_load();
+	watchdog_init(9);
+#ifndef USE_SHT3X
+	am2302_init();
+	warmup_init();
+#endif
+	protocol_init(config.repeat_count);
+	for (uint8_t job = 0; job < CONFIG_SENSORS; job++) {
+#ifndef USE_DS18X20
+		if (job == JOB_DS18X20) continue;
+#endif
+		scheduler_init(job, config.period[job], config.period_min[job], config.period_max[job]);
+		report_init(job, config.id[job], config.protocol[job], config.delta_temp[job], config.delta_humidity[job]);
+	}
+#ifdef USE_DS18X20
+	for (uint8_t probe = 1; probe < DS18X20_PROBES; probe++) {
+		report_init(JOB_DS18X20 + probe, config.id[JOB_DS18X20] + probe, config.protocol[JOB_DS18X20], config.delta_temp[JOB_DS18X20], 0);
+	}
+	probes_init();
+#endif
+
+ 	sei();
+	watchdog_calibrate();
+	// own transmit times per node: the IDs, and the watchdog period that
+	// differs between chips for nodes with the same IDs
+	jitter_init((((uint16_t)config.id[JOB_AM2302] << 8) | config.id[JOB_DS18X20]) ^ watchdog_tick_us());
+
+	while(1)
+	{
+		uint8_t jobs = scheduler_due();
+		if (jobs) {
+			scheduler_awake(measure(jobs)); // the clock runs on while awake
+			scheduler_done(jobs);
+		}
+		scheduler_sleep();
 	}
 	return 0;
 }
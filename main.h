@@ -20,11 +20,93 @@
 #define PORT_VCC	PORTB
 #define PIN_VCC		PB3
 
+// SHT3x on the USI I2C bus (SDA PB0, SCL PB2) instead of the AM2302,
+// the 1-Wire bus moves to PB4
+//#define USE_SHT3X
+
+#ifdef USE_SHT3X
+#define PINS_UNUSED	0
+#else
+#define PINS_UNUSED	(1 << PB0)	// kept as inputs with pull-up
+#endif
+
+// defaults of the runtime configuration (config.h), used if the
+// EEPROM does not hold a valid record
+
 #define ID1			0x21
 #define ID2			0x22
 
+// 433 MHz frame format per sensor ID, PROTOCOL_* of protocol.h, with
+// PROTOCOL_NATIVE all readings of a cycle share one frame (native.h)
+#define PROTOCOL_ID1		PROTOCOL_KW9010
+#define PROTOCOL_ID2		PROTOCOL_KW9010
+
+#define REPEAT_COUNT		3	// KW9010 and Nexus frame repeats, Oregon is always sent twice
+#define DS18B20_RESOLUTION	12	// bit
+
+// send-on-change thresholds per sensor ID, in 0.1 C and 0.1 %
+#define DELTA_TEMP_ID1		3
+#define DELTA_HUMIDITY_ID1	20
+#define DELTA_TEMP_ID2		2
+
 #define USE_DS18X20
+#define DS18X20_PROBES	4	// max. probes on the 1-Wire bus, sensor IDs ID2, ID2+1, ...
+#if DS18X20_PROBES > 7
+#error "probes and report slots are kept in uint8_t bitmasks"
+#endif
+// probes can be parasitic powered (VDD and GND to GND, 4k7 to the switched
+// VCC), this is detected at boot
+
+// comfort band of the probes in C (TL, TH), a probe outside is read and sent
+// at once, the others only every PROBES_HEARTBEAT cycles; off if equal
+#define DS18X20_ALARM_LOW	0
+#define DS18X20_ALARM_HIGH	0
+
+// phases of a measurement cycle in ms after switching on the sensors
+#define DS18X20_CONVERSION_MS(bits)	((750 >> (12 - (bits))) * 9 / 8)	// 94/188/375/750ms at 9..12 bit plus watchdog tolerance
+#define AM2302_WARMUP_MS		2000	// am2302 needs around 2 seconds after power on, start value of warmup.h
+
+// store and forward: readings are not sent one by one but kept in a RAM
+// ring of BATCH_SAMPLES per sensor ID, every BATCH_EVERY readings the ring
+// goes out as one burst frame (batch.h), 35 bytes RAM per sensor ID
+//#define USE_BATCH
+#define BATCH_SAMPLES	6
+#define BATCH_EVERY		3	// below BATCH_SAMPLES every reading is sent more than once
 
 //#define DEBUGMODE
 
+// scheduler jobs, one per sensor (read and send)
+#define JOB_AM2302		0	// humidity sensor, AM2302 or SHT3x
+#define JOB_DS18X20		1
+
+// reporting periods in scheduler ticks of 8 seconds
+// the period is halved down to PERIOD_MIN_* while the readings change fast
+// and stretched up to PERIOD_MAX_* while they are flat
+#ifdef DEBUGMODE
+#define PERIOD_AM2302		2		// 16 Sekunden
+#define PERIOD_MIN_AM2302	2
+#define PERIOD_MAX_AM2302	2
+#define PERIOD_DS18X20		2		// 16 Sekunden
+#define PERIOD_MIN_DS18X20	2
+#define PERIOD_MAX_DS18X20	2
+#else
+#define PERIOD_AM2302		(10*60/8)	// 10 Minuten
+#define PERIOD_MIN_AM2302	(2*60/8)
+#define PERIOD_MAX_AM2302	(30*60/8)
+#define PERIOD_DS18X20		(2*60/8)	// 2 Minuten
+#define PERIOD_MIN_DS18X20	(1*60/8)
+#define PERIOD_MAX_DS18X20	(20*60/8)
+#endif
+
+// below this supply voltage the battery flag is sent and all periods
+// are stretched by 2^BATTERY_LOW_STRETCH
+#define BATTERY_LOW_MV			3300
+#define BATTERY_LOW_STRETCH		2
+
+// rate of change per hour (0.1 C/h, 0.1 %/h) for fast and flat readings
+#define SLOPE_FAST_TEMP			30
+#define SLOPE_FLAT_TEMP			5
+#define SLOPE_FAST_HUMIDITY		100
+#define SLOPE_FLAT_HUMIDITY		20
+
 #endif /* MAIN_H_ */
@@ -0,0 +1,74 @@
+/*
+ * native.c
+ *
+ * Compact frame with all readings of one measurement cycle.
+ */
+
+#include <avr/pgmspace.h>
+
+#include "native.h"
+#include "onewire.h"
+#include "radio.h"
+
+#if NATIVE_BYTES(NATIVE_RECORDS) > RADIO_FRAME_BYTES
+#error "RADIO_FRAME_BYTES too small for NATIVE_RECORDS"
+#endif
+#if NATIVE_RECORDS > 7
+#error "the header counts up to 7 records"
+#endif
+
+static const radio_protocol_t _native_protocol PROGMEM = {
+	.sync = { RADIO_HIGH(NATIVE_SYNC), RADIO_LOW(NATIVE_SYNC) },
+	.zero = { RADIO_HIGH(NATIVE_LONG), RADIO_LOW(NATIVE_SHORT) },
+	.one = { RADIO_HIGH(NATIVE_SHORT), RADIO_LOW(NATIVE_LONG) },
+	.gap = { RADIO_LOW(NATIVE_GAP) },
+	.flags = 0,
+};
+
+static uint8_t _native_frame[NATIVE_BYTES(NATIVE_RECORDS)];
+static uint8_t _native_count = 0;
+
+// humidity in 0.1 %, NATIVE_NO_HUMIDITY for temperature only sensors
+void native_add(uint8_t id, int16_t temperature, uint16_t humidity)
+{
+	uint8_t *r;
+	uint16_t t = (uint16_t)temperature & 0x0FFF;
+
+	if (_native_count >= NATIVE_RECORDS) {
+		return;
+	}
+	r = &_native_frame[1 + _native_count * NATIVE_RECORD_BYTES];
+	if (humidity > NATIVE_NO_HUMIDITY) {
+		humidity = NATIVE_NO_HUMIDITY;
+	}
+	r[0] = id;
+	r[1] = t >> 4;
+	r[2] = (t << 4) | (humidity >> 8);
+	r[3] = humidity & 0xFF;
+	_native_count++;
+}
+
+// send the collected records, if any, and start a new frame
+// returns the airtime in ms
+uint16_t native_send(uint8_t battery_ok, uint8_t repeatCount)
+{
+	uint8_t len = 1 + _native_count * NATIVE_RECORD_BYTES;
+
+	if (!_native_count) {
+		return 0;
+	}
+	_native_frame[0] = NATIVE_MAGIC | (battery_ok ? 0x08 : 0x00) | _native_count;
+	_native_count = 0;
+	return native_transmit(_native_frame, len, repeatCount);
+}
+
+// append the crc to len bytes (frame has room for it) and send them with
+// the native coding, also used for the burst frames of batch.c
+// returns the airtime in ms
+uint16_t native_transmit(uint8_t *frame, uint8_t len, uint8_t repeatCount)
+{
+	frame[len] = onewire_crc(frame, len);
+	radio_send(&_native_protocol, frame, (len + 1) * 8, repeatCount);
+	radio_wait();
+	return NATIVE_AIRTIME_MS(len + 1, repeatCount);
+}
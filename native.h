@@ -0,0 +1,48 @@
+/*
+ * native.h
+ *
+ * Compact frame for our own receivers: all readings of one measurement
+ * cycle in a single transmission, protected by onewire_crc().
+ *
+ * Readings of sensor IDs with PROTOCOL_NATIVE are collected with
+ * native_add() and sent together by native_send() at the end of the cycle.
+ *
+ * Frame, MSB first:
+ *   header  magic 0xA (4), battery ok (1), record count (3)
+ *   record  sensor ID (8), temperature in 0.1 C (12, two's complement),
+ *           humidity in 0.1 % (12, NATIVE_NO_HUMIDITY if none)
+ *   crc     onewire_crc() over header and records
+ *
+ * Pulse width coded, 750us per bit: 250us high 500us low is a 1, 500us
+ * high 250us low a 0, as the OOK_PWM slicer of rtl_433 reads it. A 1000us
+ * sync pulse and pause precede the frame, a 4000us pause follows it.
+ * Decoded by host/native_decode.
+ */
+
+#ifndef NATIVE_H_
+#define NATIVE_H_
+
+#include <stdint.h>
+
+#include "report.h"
+
+#define NATIVE_MAGIC		0xA0
+#define NATIVE_RECORDS		REPORT_SLOTS	// at most one record per sensor ID
+#define NATIVE_RECORD_BYTES	4
+#define NATIVE_BYTES(records)	(1 + (records) * NATIVE_RECORD_BYTES + 1)
+#define NATIVE_NO_HUMIDITY	0xFFF
+
+#define NATIVE_SHORT		250		// us
+#define NATIVE_LONG			500
+#define NATIVE_SYNC			1000
+#define NATIVE_GAP			4000
+
+// time in ms a frame of this many bytes keeps the transmitter busy
+#define NATIVE_AIRTIME_MS(bytes, repeatCount) \
+	(((bytes) * 8UL * (NATIVE_SHORT + NATIVE_LONG) + 2 * NATIVE_SYNC + NATIVE_GAP) * (repeatCount) / 1000)
+
+void native_add(uint8_t id, int16_t temperature, uint16_t humidity);
+uint16_t native_send(uint8_t battery_ok, uint8_t repeatCount);
+uint16_t native_transmit(uint8_t *frame, uint8_t len, uint8_t repeatCount);
+
+#endif /* NATIVE_H_ */
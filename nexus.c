@@ -0,0 +1,35 @@
+/*
+ * nexus.c
+ *
+ * Nexus-TH sender.
+ */
+
+#include <avr/pgmspace.h>
+
+#include "nexus.h"
+#include "radio.h"
+
+// the line is quiet before the first row, the gap closes each row
+static const radio_protocol_t _nexus_protocol PROGMEM = {
+	.sync = { 0 },
+	.zero = { RADIO_HIGH(NEXUS_PULSE), RADIO_LOW(NEXUS_ZERO) },
+	.one = { RADIO_HIGH(NEXUS_PULSE), RADIO_LOW(NEXUS_ONE) },
+	.gap = { RADIO_HIGH(NEXUS_PULSE), RADIO_LOW(NEXUS_SYNC) },
+	.flags = 0,
+};
+
+// temperature in 0.1 C, humidity in %, channel 0..2
+void nexus_send(int16_t temperature, uint8_t humidity, uint8_t battery_ok, uint8_t id, uint8_t channel, uint8_t repeatCount)
+{
+	uint8_t data[5];
+	uint16_t t = (uint16_t)temperature & 0x0FFF;
+
+	data[0] = id;
+	data[1] = (battery_ok ? 0x80 : 0x00) | ((channel & 0x03) << 4) | (t >> 8);
+	data[2] = t & 0xFF;
+	data[3] = 0xF0 | (humidity >> 4);
+	data[4] = humidity << 4;
+
+	radio_send(&_nexus_protocol, data, NEXUS_BITS, NEXUS_ROWS(repeatCount));
+	radio_wait();
+}
@@ -0,0 +1,33 @@
+/*
+ * nexus.h
+ *
+ * Nexus-TH sender (also sold as Sencor, Digoo, Rubicson and others).
+ *
+ * Pulse distance coded: every bit is a 500us pulse followed by a 1000us
+ * (0) or 2000us (1) pause, each row ends with a pulse and a 4000us pause.
+ * The 36 bit row is ID (8), battery ok (1), 0 (1), channel (2),
+ * temperature in 0.1 C (12, two's complement), 1111 (4), humidity in %
+ * (8). There is no checksum, receivers wait for repeated rows, at least
+ * NEXUS_ROWS_MIN are sent whatever the repeat count.
+ */
+
+#ifndef NEXUS_H_
+#define NEXUS_H_
+
+#include <stdint.h>
+
+#define NEXUS_PULSE		500
+#define NEXUS_ZERO		1000
+#define NEXUS_ONE		2000
+#define NEXUS_SYNC		4000
+#define NEXUS_BITS		36
+#define NEXUS_ROWS_MIN	3	// rtl_433 looks for 3 equal rows
+
+#define NEXUS_ROWS(repeatCount)	((repeatCount) < NEXUS_ROWS_MIN ? NEXUS_ROWS_MIN : (repeatCount))
+
+// shortest time in ms a nexus_send() keeps the transmitter busy (all bits 0)
+#define NEXUS_AIRTIME_MS(repeatCount) ((NEXUS_BITS * (NEXUS_PULSE + NEXUS_ZERO) + NEXUS_PULSE + NEXUS_SYNC) * (uint32_t)NEXUS_ROWS(repeatCount) / 1000)
+
+void nexus_send(int16_t temperature, uint8_t humidity, uint8_t battery_ok, uint8_t id, uint8_t channel, uint8_t repeatCount);
+
+#endif /* NEXUS_H_ */
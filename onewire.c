@@ -24,6 +24,223 @@
 
 #include "onewire.h"
 
+// running CRC of all received bits, see onewire_crc_start()
+static uint8_t _onewire_crc;
+static uint8_t _onewire_crc_zero;
+
+// one bit of the CRC, done in the slack of the read slot (about 8 cycles)
+#define ONEWIRE_CRC_BIT(bit) \
+    _onewire_crc_zero |= (bit); \
+    if ((_onewire_crc ^ (bit)) & 1) { \
+        _onewire_crc = (_onewire_crc >> 1) ^ 0x8C; \
+    } else { \
+        _onewire_crc >>= 1; \
+    }
+#define ONEWIRE_CRC_BIT_US  8
+
+#ifdef ONEWIRE_ASYNC
+
+#include <avr/sleep.h>
+
+/*
+ * Timer0 runs at CK/8, the compare A interrupt steps through the states.
+ * Every slot starts in the interrupt, the short low pulse and the read
+ * sample are done there with interrupts off, the rest of the slot and the
+ * reset pulses are timer compares while the CPU sleeps.
+ */
+#define ONEWIRE_TICKS(us)   ((uint8_t)((us) * (F_CPU / 1000000UL) / 8))
+
+enum onewire_state {
+    ONEWIRE_IDLE,
+    ONEWIRE_RESET_RELEASE,      // end of the 480us reset pulse
+    ONEWIRE_RESET_PRESENCE,     // sample the presence pulse
+    ONEWIRE_RESET_END,          // end of the presence window
+    ONEWIRE_SLOT,               // start of a bit slot
+    ONEWIRE_SLOT_RELEASE,       // end of the low time of a written 0
+    ONEWIRE_DONE                // last slot finished
+};
+
+volatile uint8_t onewire_busy;
+
+static volatile uint8_t _onewire_state = ONEWIRE_IDLE;
+static volatile uint8_t _onewire_rc;
+static uint8_t *_onewire_data;
+static uint8_t _onewire_cnt;
+static uint8_t _onewire_read;       // reading, else writing
+static uint8_t _onewire_byte;       // byte in transfer
+static uint8_t _onewire_bit;        // bits left in _onewire_byte
+static uint8_t _onewire_pu;         // strong pull up after the last bit
+
+static void _onewire_start(uint8_t state, uint8_t ticks) {
+    PRR &= ~(1<<PRTIM0);
+    TCCR0A = 0;
+    TCCR0B = (1<<CS01);             // CK/8
+    OCR0A = TCNT0 + ticks;
+    TIFR = (1<<OCF0A);
+    _onewire_state = state;
+    onewire_busy = 1;
+    TIMSK |= (1<<OCIE0A);
+}
+
+static void _onewire_stop(void) {
+    TIMSK &= ~(1<<OCIE0A);
+    TCCR0B = 0;
+    _onewire_state = ONEWIRE_IDLE;
+    onewire_busy = 0;
+}
+
+ISR(TIMER0_COMPA_vect) {
+    uint8_t bit;
+
+    switch (_onewire_state) {
+        case ONEWIRE_RESET_RELEASE:
+            ONEWIRE_TRISTATE
+            _onewire_state = ONEWIRE_RESET_PRESENCE;
+            OCR0A += ONEWIRE_TICKS(66);
+        break;
+
+        case ONEWIRE_RESET_PRESENCE:
+            if (ONEWIRE_READ) {         // no presence pulse detect
+                _onewire_rc = ONEWIRE_NO_PRESENCE;
+            }
+            _onewire_state = ONEWIRE_RESET_END;
+            OCR0A += ONEWIRE_TICKS(414);
+        break;
+
+        case ONEWIRE_RESET_END:
+            if (!ONEWIRE_READ) {        // bus short circuit to GND
+                _onewire_rc = ONEWIRE_GND_SHORT;
+            }
+            _onewire_stop();
+        break;
+
+        case ONEWIRE_SLOT:
+            if (_onewire_read) {
+                ONEWIRE_LOW
+                _delay_us(3);
+                ONEWIRE_TRISTATE
+                _delay_us(8);           // interrupt latency adds to the 15us sample time
+                bit = ONEWIRE_READ ? 1 : 0;
+                ONEWIRE_CRC_BIT(bit)
+                _onewire_byte = (_onewire_byte >> 1) | (bit << 7);
+                OCR0A += ONEWIRE_TICKS(100);
+            } else if (_onewire_byte & 1) {     // write 1
+                ONEWIRE_LOW
+                _delay_us(3);
+                ONEWIRE_TRISTATE
+                _onewire_byte >>= 1;
+                OCR0A += ONEWIRE_TICKS(100);
+            } else {                    // write 0
+                ONEWIRE_LOW
+                _onewire_byte >>= 1;
+                _onewire_state = ONEWIRE_SLOT_RELEASE;
+                OCR0A += ONEWIRE_TICKS(80);
+                break;
+            }
+            // no break
+
+        case ONEWIRE_SLOT_RELEASE:
+            if (_onewire_state == ONEWIRE_SLOT_RELEASE) {
+                ONEWIRE_TRISTATE
+                OCR0A += ONEWIRE_TICKS(20);
+            }
+            _onewire_state = ONEWIRE_SLOT;
+            if (--_onewire_bit == 0) {  // byte done
+                if (_onewire_read) {
+                    *_onewire_data = _onewire_byte;
+                }
+                _onewire_data++;
+                if (--_onewire_cnt == 0) {
+                    if (_onewire_pu) {  // within 10us after the last bit
+                        ONEWIRE_STRONG_PU_ON
+                        _onewire_pu = 0;
+                    }
+                    _onewire_state = ONEWIRE_DONE;
+                } else {
+                    _onewire_bit = 8;
+                    if (!_onewire_read) {
+                        _onewire_byte = *_onewire_data;
+                    }
+                }
+            }
+        break;
+
+        case ONEWIRE_DONE:
+        default:
+            _onewire_stop();
+        break;
+    }
+}
+
+void onewire_reset_start(void) {
+    _onewire_rc = ONEWIRE_OK;
+    ONEWIRE_LOW
+    _onewire_start(ONEWIRE_RESET_RELEASE, ONEWIRE_TICKS(480));
+}
+
+static void _onewire_transfer_start(uint8_t *data, uint8_t cnt, uint8_t read) {
+    if (!cnt) {
+        return;
+    }
+    _onewire_data = data;
+    _onewire_cnt = cnt;
+    _onewire_read = read;
+    _onewire_bit = 8;
+    _onewire_byte = read ? 0 : *data;
+    _onewire_start(ONEWIRE_SLOT, 1);
+}
+
+void onewire_write_start(const uint8_t *data, uint8_t cnt) {
+    _onewire_pu = 0;
+    _onewire_transfer_start((uint8_t *)data, cnt, 0);
+}
+
+void onewire_write_pu_start(const uint8_t *data, uint8_t cnt) {
+    _onewire_pu = 1;
+    _onewire_transfer_start((uint8_t *)data, cnt, 0);
+}
+
+void onewire_read_start(uint8_t *data, uint8_t cnt) {
+    _onewire_pu = 0;
+    _onewire_transfer_start(data, cnt, 1);
+}
+
+uint8_t onewire_wait(void) {
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    while (1) {
+        cli();
+        if (!onewire_busy) {
+            sei();
+            break;
+        }
+        sleep_enable();
+        sei();
+        sleep_cpu();
+        sleep_disable();
+    }
+    return _onewire_rc;
+}
+
+uint8_t onewire_reset(void) {
+    onewire_reset_start();
+    return onewire_wait();
+}
+
+uint8_t onewire_read_byte(void) {
+    uint8_t data;
+
+    onewire_read_start(&data, 1);
+    onewire_wait();
+    return data;
+}
+
+void onewire_write_byte(uint8_t data) {
+    onewire_write_start(&data, 1);
+    onewire_wait();
+}
+
+#else
+
 uint8_t onewire_reset(void) {
     uint8_t rc=ONEWIRE_OK;
 
@@ -44,6 +261,32 @@ uint8_t onewire_reset(void) {
     return rc;
 }
 
+uint8_t onewire_read_byte(void) {
+    uint8_t data=0;
+    uint8_t i;
+
+    for (i=0; i<8; i++) {
+        data >>= 1;         // LSB first on OneWire
+        if (onewire_read_bit()) {
+            data |= 0x80;
+        }
+    }
+    return data;
+}
+
+void onewire_write_byte(uint8_t data) {
+    uint8_t i;
+
+    for (i=0; i<8; i++) {       
+        // LSB first on OneWire
+        // no need for masking, LSB is masked inside function
+        onewire_write_bit(data);
+        data >>= 1;
+    }
+}
+
+#endif
+
 void onewire_write_bit(uint8_t wrbit) {
 
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
@@ -69,8 +312,9 @@ uint8_t onewire_read_bit(void) {
         _delay_us(3);
         ONEWIRE_TRISTATE
         _delay_us(12);
-        readbit = ONEWIRE_READ;
-        _delay_us(85);
+        readbit = ONEWIRE_READ ? 1 : 0;
+        ONEWIRE_CRC_BIT(readbit)
+        _delay_us(85 - ONEWIRE_CRC_BIT_US);
     }
 
     if (readbit) {
@@ -80,30 +324,6 @@ uint8_t onewire_read_bit(void) {
     }   
 }
 
-uint8_t onewire_read_byte(void) {
-    uint8_t data=0;
-    uint8_t i;
-
-    for (i=0; i<8; i++) {
-        data >>= 1;         // LSB first on OneWire
-        if (onewire_read_bit()) {
-            data |= 0x80;
-        }
-    }
-    return data;
-}
-
-void onewire_write_byte(uint8_t data) {
-    uint8_t i;
-
-    for (i=0; i<8; i++) {       
-        // LSB first on OneWire
-        // no need for masking, LSB is masked inside function
-        onewire_write_bit(data);
-        data >>= 1;
-    }
-}
-
 void onewire_search_init(uint8_t buffer[8]) {
     memset(buffer, 0, 8);
     onewire_search(NULL, 0);
@@ -319,6 +539,85 @@ uint8_t onewire_crc(const uint8_t *data, uint8_t cnt) {
     }
 }
 
+void onewire_crc_start(void) {
+    _onewire_crc = 0;
+    _onewire_crc_zero = 0;
+}
+
+void onewire_crc_update(uint8_t data) {
+    uint8_t i, bit;
+
+    for (i=0; i<8; i++) {
+        bit = data & 1;
+        ONEWIRE_CRC_BIT(bit)
+        data >>= 1;
+    }
+}
+
+uint8_t onewire_crc_result(void) {
+    if (!_onewire_crc_zero) {  // all data was zero, this is an error!
+        return 0xFF;
+    } else {
+        return _onewire_crc;
+    }
+}
+
+#ifdef ONEWIRE_CRC_TABLE
+
+uint8_t onewire_crc_table(const uint8_t *data, uint8_t cnt) {
+
+    static const uint8_t crc_table[256] PROGMEM = {
+     0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83,
+     0xC2, 0x9C, 0x7E, 0x20, 0xA3, 0xFD, 0x1F, 0x41,
+     0x9D, 0xC3, 0x21, 0x7F, 0xFC, 0xA2, 0x40, 0x1E,
+     0x5F, 0x01, 0xE3, 0xBD, 0x3E, 0x60, 0x82, 0xDC,
+     0x23, 0x7D, 0x9F, 0xC1, 0x42, 0x1C, 0xFE, 0xA0,
+     0xE1, 0xBF, 0x5D, 0x03, 0x80, 0xDE, 0x3C, 0x62,
+     0xBE, 0xE0, 0x02, 0x5C, 0xDF, 0x81, 0x63, 0x3D,
+     0x7C, 0x22, 0xC0, 0x9E, 0x1D, 0x43, 0xA1, 0xFF,
+     0x46, 0x18, 0xFA, 0xA4, 0x27, 0x79, 0x9B, 0xC5,
+     0x84, 0xDA, 0x38, 0x66, 0xE5, 0xBB, 0x59, 0x07,
+     0xDB, 0x85, 0x67, 0x39, 0xBA, 0xE4, 0x06, 0x58,
+     0x19, 0x47, 0xA5, 0xFB, 0x78, 0x26, 0xC4, 0x9A,
+     0x65, 0x3B, 0xD9, 0x87, 0x04, 0x5A, 0xB8, 0xE6,
+     0xA7, 0xF9, 0x1B, 0x45, 0xC6, 0x98, 0x7A, 0x24,
+     0xF8, 0xA6, 0x44, 0x1A, 0x99, 0xC7, 0x25, 0x7B,
+     0x3A, 0x64, 0x86, 0xD8, 0x5B, 0x05, 0xE7, 0xB9,
+     0x8C, 0xD2, 0x30, 0x6E, 0xED, 0xB3, 0x51, 0x0F,
+     0x4E, 0x10, 0xF2, 0xAC, 0x2F, 0x71, 0x93, 0xCD,
+     0x11, 0x4F, 0xAD, 0xF3, 0x70, 0x2E, 0xCC, 0x92,
+     0xD3, 0x8D, 0x6F, 0x31, 0xB2, 0xEC, 0x0E, 0x50,
+     0xAF, 0xF1, 0x13, 0x4D, 0xCE, 0x90, 0x72, 0x2C,
+     0x6D, 0x33, 0xD1, 0x8F, 0x0C, 0x52, 0xB0, 0xEE,
+     0x32, 0x6C, 0x8E, 0xD0, 0x53, 0x0D, 0xEF, 0xB1,
+     0xF0, 0xAE, 0x4C, 0x12, 0x91, 0xCF, 0x2D, 0x73,
+     0xCA, 0x94, 0x76, 0x28, 0xAB, 0xF5, 0x17, 0x49,
+     0x08, 0x56, 0xB4, 0xEA, 0x69, 0x37, 0xD5, 0x8B,
+     0x57, 0x09, 0xEB, 0xB5, 0x36, 0x68, 0x8A, 0xD4,
+     0x95, 0xCB, 0x29, 0x77, 0xF4, 0xAA, 0x48, 0x16,
+     0xE9, 0xB7, 0x55, 0x0B, 0x88, 0xD6, 0x34, 0x6A,
+     0x2B, 0x75, 0x97, 0xC9, 0x4A, 0x14, 0xF6, 0xA8,
+     0x74, 0x2A, 0xC8, 0x96, 0x15, 0x4B, 0xA9, 0xF7,
+     0xB6, 0xE8, 0x0A, 0x54, 0xD7, 0x89, 0x6B, 0x35
+    };
+
+    uint8_t crc=0, zerocheck=0;
+
+    // one table lookup per byte, 256 bytes of flash
+    for(; cnt>0; cnt--) {
+        zerocheck |= *data;
+        crc = pgm_read_byte(&crc_table[crc ^ *data++]);
+    }
+
+    if (!zerocheck) {        // all data was zero, this is an error!
+        return 0xFF;
+    } else {
+        return crc;
+    }
+}
+
+#endif
+
 /*-----------------------------------------------------------------------------
 
     calculate CRC over data array
@@ -53,16 +53,40 @@
 
 #include <avr/io.h>
 
+#include "main.h"
+
 /** \defgroup ONEWIRE_CONFIGURATION ONEWIRE CONFIGURATION
   static configuration of IO port and pin
 */
 /*@{*/
+#ifdef USE_SHT3X
+#define ONEWIRE_BIT  PB4  // PB2 is the I2C clock
+#else
 #define ONEWIRE_BIT  PB2
+#endif
 #define ONEWIRE_PIN  PINB
 #define ONEWIRE_PORT PORTB
 #define ONEWIRE_DDR  DDRB
 /*@}*/
 
+/** \defgroup ONEWIRE_ASYNC_CONFIGURATION ONEWIRE ASYNC CONFIGURATION
+  reset and byte transfers are timed by Timer0 compare interrupts (CK/8),
+  the blocking functions sleep in idle mode until the transfer is done.
+  Interrupts are only held off for the first 15us of a slot.
+  onewire_read_bit() and onewire_write_bit() (ROM search) stay busy waiting.
+*/
+/*@{*/
+//#define ONEWIRE_ASYNC
+/*@}*/
+
+/** \defgroup ONEWIRE_CRC_CONFIGURATION ONEWIRE CRC CONFIGURATION
+  adds onewire_crc_table(), fastest CRC over a buffer for 256 bytes of flash,
+  compare the variants with make bench (crc_bench.c)
+*/
+/*@{*/
+//#define ONEWIRE_CRC_TABLE
+/*@}*/
+
 /** \defgroup ONEWIRE_CONTROL ONEWIRE CONTROL
   control macros for strong pull up, used for parasitic power supply
 */
@@ -82,6 +106,27 @@
 
 /*@}*/
 
+/** \defgroup ONEWIRE_SIM ONEWIRE SIMULATION
+  host build against a simulated bus, see host/onewire_sim.c
+*/
+/*@{*/
+#ifdef ONEWIRE_SIM
+void onewire_sim_low(void);
+void onewire_sim_release(void);
+uint8_t onewire_sim_read(void);
+#undef ONEWIRE_STRONG_PU_ON
+#undef ONEWIRE_STRONG_PU_OFF
+#undef ONEWIRE_LOW
+#undef ONEWIRE_TRISTATE
+#undef ONEWIRE_READ
+#define ONEWIRE_STRONG_PU_ON    onewire_sim_release();
+#define ONEWIRE_STRONG_PU_OFF
+#define ONEWIRE_LOW             onewire_sim_low();
+#define ONEWIRE_TRISTATE        onewire_sim_release();
+#define ONEWIRE_READ            onewire_sim_read()
+#endif
+/*@}*/
+
 /** \defgroup ONEWIRE_COMMANDS ONEWIRE COMMANDS
   command codes for onewire
 */
@@ -242,8 +287,108 @@ uint8_t onewire_crc(const uint8_t *data, uint8_t cnt);
 
 uint8_t onewire_crc_serial(const uint8_t *data, uint8_t cnt);
 
+/**
+ \brief calculate CRC over data array, one table lookup per byte, 256 bytes of flash
+ \brief only with ONEWIRE_CRC_TABLE defined
+ \param *data pointer to buffer array
+ \param cnt number of data bytes
+ \return calculated CRC, zero over data including its CRC
+ \return Over data without the CRC the CRC itself is returned, no placeholder needed.
+ \return If all data bytes are zero, 0xFF is returned to indicate an error
+ */
+
+uint8_t onewire_crc_table(const uint8_t *data, uint8_t cnt);
+
+/**
+ \brief reset the running CRC
+ \brief every bit read afterwards is added inside its read slot, so the
+ \brief CRC is ready with the last bit at no extra time
+ \param none
+ \return none
+ */
+
+void onewire_crc_start(void);
+
+/**
+ \brief add a byte to the running CRC, e.g. for written data
+ \param data byte
+ \return none
+ */
+
+void onewire_crc_update(uint8_t data);
+
+/**
+ \brief running CRC since onewire_crc_start()
+ \param none
+ \return zero if the bits read include a valid CRC
+ \return If all bits were zero, 0xFF is returned to indicate an error
+ */
+
+uint8_t onewire_crc_result(void);
+
 /*@}*/
 
+#ifdef ONEWIRE_ASYNC
+
+/** \defgroup ONEWIRE_ASYNC_FUNCTIONS ONEWIRE ASYNC FUNCTIONS
+  * background transfers, interrupts must be enabled
+  */
+/*@{*/
+
+/**
+ \brief set while a background transfer is running
+ */
+
+extern volatile uint8_t onewire_busy;
+
+/**
+ \brief start onewire reset in the background
+ \param none
+ \return none, result with onewire_result() when onewire_busy is cleared
+ */
+
+void onewire_reset_start(void);
+
+/**
+ \brief start writing bytes in the background
+ \param *data pointer to data array, must stay valid until done
+ \param cnt number of bytes
+ \return none
+ */
+
+void onewire_write_start(const uint8_t *data, uint8_t cnt);
+
+/**
+ \brief start writing bytes in the background, strong pull up right after the last bit
+ \brief for parasitic power, switch it off with ONEWIRE_STRONG_PU_OFF
+ \param *data pointer to data array, must stay valid until done
+ \param cnt number of bytes
+ \return none
+ */
+
+void onewire_write_pu_start(const uint8_t *data, uint8_t cnt);
+
+/**
+ \brief start reading bytes in the background
+ \param *data pointer to buffer array, valid when onewire_busy is cleared
+ \param cnt number of bytes
+ \return none
+ */
+
+void onewire_read_start(uint8_t *data, uint8_t cnt);
+
+/**
+ \brief sleep in idle mode until the background transfer is done
+ \param none
+ \return error code of the last reset, see onewire_reset()
+ */
+
+uint8_t onewire_wait(void);
+
+/*@}*/
+
+#endif
+
 /** \defgroup ONEWIRE_PRIVATE ONEWIRE PRIVATE FUNCTIONS
 */
 /*@{*/
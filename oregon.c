@@ -0,0 +1,83 @@
+/*
+ * oregon.c
+ *
+ * Oregon Scientific v2.1 sender, emulates a THGR228N.
+ */
+
+#include <string.h>
+#include <avr/pgmspace.h>
+
+#include "oregon.h"
+#include "radio.h"
+
+#define OREGON_TYPE		0x1A2D
+
+// v2.1 sends each bit twice, inverted first: three phases per bit, the
+// neighbouring halves of equal level merge
+static const radio_protocol_t _oregon_protocol PROGMEM = {
+	.sync = { 0 },
+	.zero = { RADIO_HIGH(OREGON_TIME), RADIO_LOW(2 * OREGON_TIME), RADIO_HIGH(OREGON_TIME) },
+	.one = { RADIO_LOW(OREGON_TIME), RADIO_HIGH(2 * OREGON_TIME), RADIO_LOW(OREGON_TIME) },
+	.gap = { RADIO_LOW(OREGON_PAUSE) },
+	.flags = 0,
+};
+
+// append bits LSB first, the radio sends MSB first
+static void _oregon_put(uint8_t *frame, uint8_t *pos, uint8_t value, uint8_t bits)
+{
+	while (bits--) {
+		if (value & 1) {
+			frame[*pos >> 3] |= 0x80 >> (*pos & 7);
+		}
+		value >>= 1;
+		(*pos)++;
+	}
+}
+
+// sum of the nibbles minus 0xA
+static uint8_t _oregon_checksum(const uint8_t *msg, uint8_t len)
+{
+	uint8_t sum = 0;
+	while (len--) {
+		sum += (*msg >> 4) + (*msg & 0x0F);
+		msg++;
+	}
+	return sum - 0xA;
+}
+
+// temperature in 0.1 C, humidity in %, channel 0..2
+void oregon_send(int16_t temperature, uint8_t humidity, uint8_t battery_ok, uint8_t id, uint8_t channel)
+{
+	uint8_t msg[9];
+	uint8_t frame[(OREGON_FRAME_BITS + 7) / 8];
+	uint8_t pos = 0;
+	uint16_t t = (temperature < 0) ? -temperature : temperature;
+
+	if (humidity > 99) {
+		humidity = 99;
+	}
+	if (t > 999) {
+		t = 999;
+	}
+	msg[0] = OREGON_TYPE >> 8;
+	msg[1] = OREGON_TYPE & 0xFF;
+	msg[2] = 0x10 << (channel % 3);
+	msg[3] = id;
+	msg[4] = ((t % 10) << 4) | (battery_ok ? 0x00 : 0x0C);
+	msg[5] = ((t / 100) << 4) | (t / 10 % 10);
+	msg[6] = ((humidity % 10) << 4) | ((temperature < 0) ? 0x08 : 0x00);
+	msg[7] = humidity / 10;
+	msg[8] = _oregon_checksum(msg, 8);
+
+	memset(frame, 0, sizeof(frame));
+	_oregon_put(frame, &pos, 0xFF, 8); // preamble
+	_oregon_put(frame, &pos, 0xFF, 8);
+	_oregon_put(frame, &pos, 0xA, 4); // sync
+	for (uint8_t i = 0; i < sizeof(msg); i++) {
+		_oregon_put(frame, &pos, msg[i], 8);
+	}
+	_oregon_put(frame, &pos, 0x00, 8); // postamble
+
+	radio_send(&_oregon_protocol, frame, OREGON_FRAME_BITS, 2);
+	radio_wait();
+}
@@ -0,0 +1,31 @@
+/*
+ * oregon.h
+ *
+ * Oregon Scientific v2.1 sender, emulates a THGR228N (temperature and
+ * humidity, sensor type 0x1A2D).
+ *
+ * Manchester coded at 1024 Hz, every data bit is sent as the inverted bit
+ * followed by the bit, LSB first. The frame is preamble (16 ones), sync
+ * nibble 0xA, 9 message bytes and an 8 bit postamble, sent twice with a
+ * pause in between as the original sensor does.
+ *
+ * Message nibbles: type 1A2D, channel, rolling code (our sensor ID),
+ * battery flag, temperature in BCD (tenths, units, tens), sign, humidity in
+ * BCD, checksum.
+ */
+
+#ifndef OREGON_H_
+#define OREGON_H_
+
+#include <stdint.h>
+
+#define OREGON_TIME			512		// us, half a bit
+#define OREGON_PAUSE		(16 * OREGON_TIME)	// between the two copies
+#define OREGON_FRAME_BITS	(16 + 4 + 9 * 8 + 8)
+
+// time in ms an oregon_send() keeps the transmitter busy
+#define OREGON_AIRTIME_MS	(2 * (OREGON_FRAME_BITS * 4UL * OREGON_TIME + OREGON_PAUSE) / 1000)
+
+void oregon_send(int16_t temperature, uint8_t humidity, uint8_t battery_ok, uint8_t id, uint8_t channel);
+
+#endif /* OREGON_H_ */
@@ -0,0 +1,54 @@
+/*
+ * power.c
+ *
+ * Lowest power sleep with peripheral gating.
+ */
+
+#include "power.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+// DIDR0 bit of each PORTB pin
+static const uint8_t _power_didr[] = {
+	(1 << AIN0D), (1 << AIN1D), (1 << ADC1D), (1 << ADC3D), (1 << ADC2D), (1 << ADC0D)
+};
+
+void power_init(void)
+{
+	ACSR |= (1 << ACD); // analog comparator is not used
+}
+
+// sleep in power down until the next interrupt
+// wake_pins: mask of PORTB pins with pin change wake-up, their input
+// buffers are kept enabled
+void power_down(uint8_t wake_pins)
+{
+	uint8_t adcsra = ADCSRA;
+	uint8_t prr = PRR;
+	uint8_t didr = DIDR0;
+	uint8_t didr_sleep = 0;
+
+	for (uint8_t pin = 0; pin < sizeof(_power_didr); pin++) {
+		if (!(wake_pins & (1 << pin))) {
+			didr_sleep |= _power_didr[pin];
+		}
+	}
+
+	ADCSRA &= ~(1 << ADEN); // the ADC has to be off before its clock is gated
+	PRR = (1 << PRTIM1) | (1 << PRTIM0) | (1 << PRUSI) | (1 << PRADC);
+	DIDR0 = didr_sleep;
+
+	set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+	cli();
+	sleep_enable();
+	sleep_bod_disable(); // timed sequence, sleep_cpu() has to follow within 3 cycles
+	sei();
+	sleep_cpu(); // System sleeps here
+	sleep_disable();
+
+	DIDR0 = didr;
+	PRR = prr;
+	ADCSRA = adcsra;
+}
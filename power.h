@@ -0,0 +1,21 @@
+/*
+ * power.h
+ *
+ * Lowest power sleep with peripheral gating.
+ *
+ * power_down() gates all peripherals with PRR, disables the brown-out
+ * detection for the time of the sleep (timed BODS sequence, rev. C silicon
+ * and later) and disables the digital input buffers of all pins that are not
+ * needed to wake up. Everything is restored before it returns, so the
+ * sensor drivers find the peripherals as they left them.
+ */
+
+#ifndef POWER_H_
+#define POWER_H_
+
+#include <stdint.h>
+
+void power_init(void);
+void power_down(uint8_t wake_pins);
+
+#endif /* POWER_H_ */
@@ -0,0 +1,252 @@
+/*
+ * probes.c
+ *
+ * Several DS18B20/DS18S20 probes on the 1-Wire bus.
+ */
+
+#include <string.h>
+#include <avr/eeprom.h>
+
+#include "probes.h"
+#include "config.h"
+#include "onewire.h"
+#include "ds18x20.h"
+
+uint8_t probes_count = 0;
+uint8_t probes_rom[PROBES_MAX][8];
+uint8_t probes_parasitic = 1;	// until checked, no polling
+
+static uint8_t _probes_cycles = 0;	// cycles since the last search
+static uint8_t _probes_rescan = 0;	// search in the next cycle
+static uint8_t _probes_configured = 0;	// resolution and power supply checked since boot or search
+static uint8_t _probes_idle[PROBES_MAX];	// cycles without a read in alarm mode
+
+static uint8_t _probes_valid(const uint8_t rom[8])
+{
+	return (rom[0] == DS18B20_ID || rom[0] == DS18S20_ID) && !onewire_crc(rom, 8);
+}
+
+// ROM codes from the EEPROM cache
+void probes_init(void)
+{
+	probes_count = eeprom_read_byte((const uint8_t *)PROBES_EEPROM_ADDR);
+	if (probes_count > PROBES_MAX) {
+		probes_count = 0;
+	}
+	eeprom_read_block(probes_rom, (const void *)(PROBES_EEPROM_ADDR + 1), sizeof(probes_rom));
+	for (uint8_t i = 0; i < probes_count; i++) {
+		if (!_probes_valid(probes_rom[i])) {
+			probes_count = 0;
+		}
+	}
+	_probes_rescan = (probes_count == 0);
+}
+
+// search the bus and update the cache, new probes are appended so the
+// existing ones keep their index and sensor ID unless one is removed
+static void _probes_search(void)
+{
+	uint8_t rom[8];
+	uint8_t found[PROBES_MAX];
+	uint8_t count = probes_count;
+	uint8_t rc;
+
+	memset(found, 0, sizeof(found));
+	onewire_search_init(rom);
+	do {
+		rc = onewire_search_rom(rom);
+		if (rc != ONEWIRE_OK && rc != ONEWIRE_LAST_CODE) {
+			return; // bus error, try again next cycle
+		}
+		if (!_probes_valid(rom)) {
+			continue;
+		}
+		uint8_t i;
+		for (i = 0; i < count; i++) {
+			if (!memcmp(probes_rom[i], rom, 8)) {
+				break;
+			}
+		}
+		if (i == count && count < PROBES_MAX) {
+			_probes_idle[count] = 0;
+			memcpy(probes_rom[count++], rom, 8);
+		}
+		if (i < PROBES_MAX) {
+			found[i] = 1;
+		}
+	} while (rc == ONEWIRE_OK);
+
+	// drop cached probes that are gone, the heartbeat counters move along
+	uint8_t n = 0;
+	for (uint8_t i = 0; i < count; i++) {
+		if (found[i]) {
+			if (n != i) {
+				memcpy(probes_rom[n], probes_rom[i], 8);
+				_probes_idle[n] = _probes_idle[i];
+			}
+			n++;
+		}
+	}
+	probes_count = n;
+
+	eeprom_update_byte((uint8_t *)PROBES_EEPROM_ADDR, probes_count);
+	eeprom_update_block(probes_rom, (void *)(PROBES_EEPROM_ADDR + 1), probes_count * 8);
+	_probes_rescan = 0;
+	_probes_cycles = 0;
+	_probes_configured = 0;
+}
+
+static uint8_t _probes_bits(void)
+{
+	uint8_t bits = config.ds18b20_resolution;
+
+	return (bits < 9 || bits > 12) ? 12 : bits;
+}
+
+uint8_t probes_alarm_mode(void)
+{
+	return config.alarm_low < config.alarm_high;
+}
+
+// set the DS18B20 resolution and the comfort band, the scratchpad is copied
+// to the probe's EEPROM only if it differs, it is recalled at every power up
+static void _probes_configure(void)
+{
+	uint8_t scratchpad[9];
+	uint8_t bits = _probes_bits();
+
+	if (onewire_skip_rom()) {
+		return;
+	}
+	probes_parasitic = ds18x20_read_power_supply(); // any parasitic probe pulls low
+
+	for (uint8_t i = 0; i < probes_count; i++) {
+		uint8_t ds18b20 = (probes_rom[i][0] == DS18B20_ID);
+
+		if (onewire_match_rom(probes_rom[i])) {
+			continue;
+		}
+		ds18x20_read_scratchpad(scratchpad);
+		if (onewire_crc_result()) {
+			continue;
+		}
+
+		int8_t th = scratchpad[2];
+		int8_t tl = scratchpad[3];
+		if (probes_alarm_mode()) {
+			th = config.alarm_high;
+			tl = config.alarm_low;
+		}
+		if (th == (int8_t)scratchpad[2] && tl == (int8_t)scratchpad[3]
+				&& (!ds18b20 || ((scratchpad[4] >> 5) & 3) + 9 == bits)) {
+			continue;
+		}
+
+		onewire_match_rom(probes_rom[i]);
+		if (ds18b20) {
+			ds18B20_write_scratchpad(tl, th, bits);
+		} else {
+			ds18S20_write_scratchpad(tl, th);
+		}
+		onewire_match_rom(probes_rom[i]);
+		ds18x20_copy_scratchpad(probes_parasitic); // handles the strong pull-up
+	}
+	_probes_configured = 1;
+}
+
+// conversion time of the slowest probe, DS18S20 always take 750ms
+uint16_t probes_conversion_ms(void)
+{
+	for (uint8_t i = 0; i < probes_count; i++) {
+		if (probes_rom[i][0] == DS18S20_ID) {
+			return DS18X20_CONVERSION_MS(12);
+		}
+	}
+	return DS18X20_CONVERSION_MS(_probes_bits());
+}
+
+// once per cycle with the sensors switched on, before the conversion
+void probes_check(void)
+{
+	if (++_probes_cycles >= PROBES_RESCAN) {
+		_probes_rescan = 1;
+	}
+	if (_probes_rescan) {
+		_probes_search();
+	}
+	if (!_probes_configured) {
+		_probes_configure();
+	}
+}
+
+// poll after convert T, externally powered probes answer read slots
+// with 0 until the conversion is done
+uint8_t probes_converting(void)
+{
+	return !probes_parasitic && !onewire_read_bit();
+}
+
+// probes to read after the conversion as bitmask, all of them without a
+// comfort band, else the ones outside (also returned in alarmed) and the
+// ones whose heartbeat is due
+uint8_t probes_due(uint8_t *alarmed)
+{
+	uint8_t rom[8];
+	uint8_t rc;
+	uint8_t due = 0;
+
+	*alarmed = 0;
+	if (!probes_alarm_mode()) {
+		return (1 << probes_count) - 1;
+	}
+
+	onewire_search_init(rom);
+	do {
+		rc = onewire_alarm_search(rom);
+		if (rc == ONEWIRE_SCAN_ERROR && !*alarmed) {
+			break; // no probe answers: none in alarm
+		}
+		if (rc != ONEWIRE_OK && rc != ONEWIRE_LAST_CODE) {
+			*alarmed = 0;
+			return (1 << probes_count) - 1; // search failed, read them all
+		}
+		for (uint8_t i = 0; i < probes_count; i++) {
+			if (!memcmp(probes_rom[i], rom, 8)) {
+				*alarmed |= (1 << i);
+			}
+		}
+	} while (rc == ONEWIRE_OK);
+
+	for (uint8_t i = 0; i < probes_count; i++) {
+		if ((*alarmed & (1 << i)) || ++_probes_idle[i] >= PROBES_HEARTBEAT) {
+			due |= (1 << i);
+			_probes_idle[i] = 0;
+		}
+	}
+	return due;
+}
+
+// end of a parasitic conversion, the bus goes back to the pull-up resistor
+void probes_release(void)
+{
+	ONEWIRE_STRONG_PU_OFF
+	ONEWIRE_PORT &= ~ONEWIRE_MASK;
+}
+
+// read a converted probe, a probe that does not answer triggers a search
+uint8_t probes_read(uint8_t probe, int16_t *temperature)
+{
+	uint8_t rc = onewire_match_rom(probes_rom[probe]);
+
+	if (!rc) {
+		if (probes_rom[probe][0] == DS18S20_ID) {
+			rc = ds18S20_read_temp(temperature);
+		} else {
+			rc = ds18B20_read_temp(temperature);
+		}
+	}
+	if (rc) {
+		_probes_rescan = 1;
+	}
+	return rc;
+}
@@ -0,0 +1,47 @@
+/*
+ * probes.h
+ *
+ * Several DS18B20/DS18S20 probes on the 1-Wire bus.
+ *
+ * The ROM codes are cached in EEPROM, the ROM search only runs if the cache
+ * is empty, a cached probe stops answering, or every PROBES_RESCAN cycles to
+ * find added probes. All probes convert at once after skip ROM, each one is
+ * then read with match ROM and sent under its own sensor ID (config ID of
+ * the DS18X20 job plus the probe index).
+ *
+ * The DS18B20 resolution from the config is checked once per boot and
+ * after a search, and only written to the probe's EEPROM if it differs.
+ * At the same time the bus is checked for parasitic powered probes, they
+ * cannot signal the end of the conversion.
+ *
+ * With a comfort band in the config, TH/TL of each probe hold the band and
+ * an alarm search after the conversion finds the probes outside. Only those
+ * are read, the others every PROBES_HEARTBEAT cycles.
+ */
+
+#ifndef PROBES_H_
+#define PROBES_H_
+
+#include <stdint.h>
+
+#include "main.h"
+
+#define PROBES_MAX		DS18X20_PROBES
+#define PROBES_RESCAN	64	// cycles between searches for added probes
+#define PROBES_POLL_MS	32	// interval of the conversion done polls
+#define PROBES_HEARTBEAT	8	// cycles between reads of a probe inside the band
+
+extern uint8_t probes_count;
+extern uint8_t probes_rom[PROBES_MAX][8];
+extern uint8_t probes_parasitic;
+
+void probes_init(void);
+void probes_check(void);
+uint8_t probes_read(uint8_t probe, int16_t *temperature);
+uint16_t probes_conversion_ms(void);
+uint8_t probes_converting(void);
+void probes_release(void);
+uint8_t probes_alarm_mode(void);
+uint8_t probes_due(uint8_t *alarmed);
+
+#endif /* PROBES_H_ */
@@ -0,0 +1,55 @@
+/*
+ * protocol.c
+ *
+ * 433 MHz frame formats, selectable per sensor ID (config.h).
+ */
+
+#include "protocol.h"
+#include "kw9010.h"
+#include "oregon.h"
+#include "nexus.h"
+
+static uint8_t _protocol_repeats = 3;
+
+void protocol_init(uint8_t repeatCount)
+{
+	_protocol_repeats = repeatCount;
+	kw9010_init(repeatCount);
+}
+
+// temperature in 0.1 C, humidity in %
+void protocol_send(uint8_t protocol, int16_t temperature, uint8_t humidity, uint8_t battery_ok, uint8_t id, uint8_t channel)
+{
+	switch (protocol)
+	{
+	case PROTOCOL_OREGON:
+		oregon_send(temperature, humidity, battery_ok, id, channel);
+		break;
+	case PROTOCOL_NEXUS:
+		nexus_send(temperature, humidity, battery_ok, id, channel, _protocol_repeats);
+		break;
+	case PROTOCOL_NATIVE:
+		break;
+	case PROTOCOL_KW9010:
+	default:
+		kw9010_send(temperature, humidity, battery_ok, id, channel);
+		break;
+	}
+}
+
+// shortest time in ms a protocol_send() keeps the transmitter busy
+uint16_t protocol_airtime_ms(uint8_t protocol)
+{
+	switch (protocol)
+	{
+	case PROTOCOL_OREGON:
+		return OREGON_AIRTIME_MS;
+	case PROTOCOL_NEXUS:
+		return NEXUS_AIRTIME_MS(_protocol_repeats);
+	case PROTOCOL_NATIVE:
+		return 0; // sent after the sensors are off
+	case PROTOCOL_KW9010:
+	default:
+		return KW9010_AIRTIME_MS(_protocol_repeats);
+	}
+}
@@ -0,0 +1,31 @@
+/*
+ * protocol.h
+ *
+ * 433 MHz frame formats, selectable per sensor ID (config.h).
+ *
+ * Each encoder builds its frame and hands it to radio_send() with its own
+ * symbol table. protocol_send() dispatches on the configured protocol.
+ * Receivers usually need to see a KW9010 or Nexus frame several times, they
+ * are repeated config.repeat_count times, Nexus rows at least NEXUS_ROWS_MIN
+ * times. Oregon Scientific frames carry a
+ * checksum and a rolling code, they are always sent twice. PROTOCOL_NATIVE
+ * readings are not sent here but collected by report.c for native_send().
+ */
+
+#ifndef PROTOCOL_H_
+#define PROTOCOL_H_
+
+#include <stdint.h>
+
+// values of config.protocol[]
+#define PROTOCOL_KW9010		0	// KW9010 / Globaltronics
+#define PROTOCOL_OREGON		1	// Oregon Scientific v2.1, THGR228N
+#define PROTOCOL_NEXUS		2	// Nexus-TH and compatibles
+#define PROTOCOL_NATIVE		3	// native.h, collected and sent once per cycle
+#define PROTOCOL_LAST		PROTOCOL_NATIVE
+
+void protocol_init(uint8_t repeatCount);
+void protocol_send(uint8_t protocol, int16_t temperature, uint8_t humidity, uint8_t battery_ok, uint8_t id, uint8_t channel);
+uint16_t protocol_airtime_ms(uint8_t protocol);
+
+#endif /* PROTOCOL_H_ */
@@ -0,0 +1,164 @@
+/*
+ * radio.c
+ *
+ * Timer1 driven OOK transmitter for the FS1000A.
+ */
+
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+
+#include "radio.h"
+
+#define RADIO_LEVEL		0x8000
+#define RADIO_CHUNK_MIN		32	// ticks, a shorter chunk may end before the ISR reloads OCR1C
+
+volatile uint8_t radio_busy = 0;
+
+static const radio_protocol_t *_radio_protocol;
+static uint8_t _radio_data[RADIO_FRAME_BYTES];
+static uint8_t _radio_bits;
+static uint8_t _radio_repeats;
+static uint8_t _radio_repeat;
+static uint8_t _radio_pos;		// 0 sync, 1..bits data, bits+1 gap
+static uint8_t _radio_invert;
+static const uint16_t *_radio_symbol;	// current symbol in PROGMEM, 0 if done
+static uint8_t _radio_phase;	// next phase in the symbol
+static uint16_t _radio_next;	// phase after the current one, 0 = end of frame
+static uint16_t _radio_ticks;	// rest of the current phase
+
+// next phase of the frame, 0 at the end
+static uint16_t _radio_advance(void)
+{
+	while (1) {
+		if (_radio_symbol) {
+			uint16_t phase = 0;
+			if (_radio_phase < RADIO_SYMBOL_PHASES) {
+				phase = pgm_read_word(&_radio_symbol[_radio_phase++]);
+			}
+			if (phase) {
+				return _radio_invert ? phase ^ RADIO_LEVEL : phase;
+			}
+			_radio_symbol = 0;
+		}
+
+		if (_radio_pos == 0) {
+			_radio_symbol = _radio_protocol->sync;
+		} else if (_radio_pos <= _radio_bits) {
+			uint8_t bit = _radio_pos - 1;
+			if (_radio_data[bit >> 3] & (0x80 >> (bit & 7))) {
+				_radio_symbol = _radio_protocol->one;
+			} else {
+				_radio_symbol = _radio_protocol->zero;
+			}
+		} else if (_radio_pos == _radio_bits + 1) {
+			_radio_symbol = _radio_protocol->gap;
+		} else {
+			if (++_radio_repeat >= _radio_repeats) {
+				return 0;
+			}
+			if (pgm_read_byte(&_radio_protocol->flags) & RADIO_INVERT_ODD) {
+				_radio_invert ^= 1;
+			}
+			_radio_pos = 0;
+			continue;
+		}
+		_radio_pos++;
+		_radio_phase = 0;
+	}
+}
+
+// next chunk of the current phase, the period is OCR1C + 1 ticks
+// a rest just above 256 ticks is split in halves instead of 256 and a
+// short tail, which would wrap the timer and add 256 ticks
+static void _radio_load(void)
+{
+	uint8_t n;
+
+	if (_radio_ticks <= 256) {
+		n = _radio_ticks - 1;
+	} else if (_radio_ticks < 256 + RADIO_CHUNK_MIN) {
+		n = (_radio_ticks >> 1) - 1;
+	} else {
+		n = 255;
+	}
+
+	_radio_ticks -= n + 1;
+	OCR1C = n;
+	OCR1A = n;
+}
+
+// pin change first, the phase lengths keep the constant interrupt latency
+ISR(TIMER1_COMPA_vect)
+{
+	if (_radio_ticks) {
+		_radio_load();
+		return;
+	}
+	if (!_radio_next) {
+		TIMSK &= ~(1 << OCIE1A);
+		TCCR1 = 0;
+		PORT_RADIO &= ~(1 << RADIO_PIN);
+		radio_busy = 0;
+		return;
+	}
+	if (_radio_next & RADIO_LEVEL) {
+		PORT_RADIO |= (1 << RADIO_PIN);
+	} else {
+		PORT_RADIO &= ~(1 << RADIO_PIN);
+	}
+	_radio_ticks = _radio_next & ~RADIO_LEVEL;
+	_radio_load();
+	_radio_next = _radio_advance();
+}
+
+// start a transmission in the background, data is copied
+void radio_send(const radio_protocol_t *protocol, const uint8_t *data, uint8_t bits, uint8_t repeats)
+{
+	radio_wait();
+
+	_radio_protocol = protocol;
+	memcpy(_radio_data, data, (bits + 7) / 8);
+	_radio_bits = bits;
+	_radio_repeats = repeats;
+	_radio_repeat = 0;
+	_radio_pos = 0;
+	_radio_invert = 0;
+	_radio_symbol = 0;
+	_radio_ticks = 0;
+	_radio_next = _radio_advance();
+	if (!repeats || !_radio_next) {
+		return;
+	}
+
+	PORT_RADIO &= ~(1 << RADIO_PIN);
+	DDR_RADIO |= (1 << RADIO_PIN);
+	PRR &= ~(1 << PRTIM1);
+	radio_busy = 1;
+	TCCR1 = 0;
+	TCNT1 = 0;
+	OCR1C = 1;
+	OCR1A = 1; // first phase starts in 2 ticks
+	TIFR = (1 << OCF1A);
+	TIMSK |= (1 << OCIE1A);
+	TCCR1 = (1 << CTC1) | (1 << CS12); // CK/8
+}
+
+// sleep in idle mode until the transmission is done
+void radio_wait(void)
+{
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	while (1) {
+		cli();
+		if (!radio_busy) {
+			sei();
+			break;
+		}
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+	}
+}
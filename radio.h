@@ -0,0 +1,48 @@
+/*
+ * radio.h
+ *
+ * Timer1 driven OOK transmitter for the FS1000A.
+ *
+ * A frame is sent as symbols from a protocol table in PROGMEM: sync, one
+ * symbol per data bit (MSB first), gap, repeated. Each symbol is a list of
+ * up to RADIO_SYMBOL_PHASES phases (level and duration). The compare A
+ * interrupt sets the pin at the start of every phase, Timer1 runs in CTC
+ * mode at CK/8. Phases longer than 256 ticks are split into chunks without
+ * a pin change. The CPU sleeps in idle mode meanwhile.
+ */
+
+#ifndef RADIO_H_
+#define RADIO_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#define DDR_RADIO	DDRB
+#define PORT_RADIO	PORTB
+#define RADIO_PIN	PB1
+
+#define RADIO_SYMBOL_PHASES	4
+#define RADIO_FRAME_BYTES	31	// batch burst of 6 samples, native frame with 5 records needs 22
+
+// phase: bit 15 level, bits 0..14 duration in Timer1 ticks (8us at 1MHz)
+#define RADIO_TICKS(us)		((uint16_t)((us) * (F_CPU / 1000000UL) / 8))
+#define RADIO_HIGH(us)		(0x8000 | RADIO_TICKS(us))
+#define RADIO_LOW(us)		RADIO_TICKS(us)
+
+// protocol flags
+#define RADIO_INVERT_ODD	0x01	// all levels inverted in every second repeat
+
+typedef struct {
+	uint16_t sync[RADIO_SYMBOL_PHASES];	// 0 terminated if shorter
+	uint16_t zero[RADIO_SYMBOL_PHASES];
+	uint16_t one[RADIO_SYMBOL_PHASES];
+	uint16_t gap[RADIO_SYMBOL_PHASES];
+	uint8_t flags;
+} radio_protocol_t;
+
+extern volatile uint8_t radio_busy;
+
+void radio_send(const radio_protocol_t *protocol, const uint8_t *data, uint8_t bits, uint8_t repeats);
+void radio_wait(void);
+
+#endif /* RADIO_H_ */
@@ -0,0 +1,76 @@
+/*
+ * report.c
+ *
+ * Send-on-change filter in front of protocol_send().
+ */
+
+#include "report.h"
+#include "protocol.h"
+#include "native.h"
+#include "batch.h"
+#include "jitter.h"
+
+static report_slot_t _slots[REPORT_SLOTS];
+static uint8_t _report_sent = 0; // a frame went out in this cycle
+
+static uint16_t _report_diff(int16_t a, int16_t b)
+{
+	return (a > b) ? a - b : b - a;
+}
+
+void report_init(uint8_t slot, uint8_t id, uint8_t protocol, uint8_t delta_temp, uint8_t delta_humidity)
+{
+	_slots[slot].id = id;
+	_slots[slot].protocol = protocol;
+	_slots[slot].delta_temp = delta_temp;
+	_slots[slot].delta_humidity = delta_humidity;
+	_slots[slot].valid = 0;
+}
+
+// the next reading of the slot is sent regardless of the change
+void report_invalidate(uint8_t slot)
+{
+	_slots[slot].valid = 0;
+}
+
+// start of a measurement cycle, the first frame goes out without a nap
+void report_cycle(void)
+{
+	_report_sent = 0;
+}
+
+// send the reading if it changed enough or the heartbeat is due
+// humidity in 0.1 %, returns the ms spent napping and transmitting, at least
+// the airtime, 0 if skipped or collected for the native frame
+// with USE_BATCH every reading is buffered for the next burst instead
+uint16_t report_send(uint8_t slot, int16_t temperature, uint16_t humidity, uint8_t battery_ok)
+{
+	report_slot_t *s = &_slots[slot];
+
+#ifdef USE_BATCH
+	batch_add(slot, s->id, temperature, (slot == JOB_AM2302) ? humidity : BATCH_NO_HUMIDITY);
+	return 0;
+#endif
+	uint8_t changed = !s->valid || s->skipped >= REPORT_HEARTBEAT;
+	if (s->delta_temp && _report_diff(temperature, s->last_temp) >= s->delta_temp) changed = 1;
+	if (s->delta_humidity && _report_diff(humidity, s->last_humidity) >= s->delta_humidity) changed = 1;
+
+	if (!changed) {
+		s->skipped++;
+		return 0;
+	}
+
+	s->last_temp = temperature;
+	s->last_humidity = humidity;
+	s->skipped = 0;
+	s->valid = 1;
+
+	if (s->protocol == PROTOCOL_NATIVE) {
+		native_add(s->id, temperature, (slot == JOB_AM2302) ? humidity : NATIVE_NO_HUMIDITY);
+		return 0;
+	}
+	uint16_t busy = _report_sent ? jitter_nap() : 0;
+	protocol_send(s->protocol, temperature, humidity/10, battery_ok, s->id, 0);
+	_report_sent = 1;
+	return busy + protocol_airtime_ms(s->protocol);
+}
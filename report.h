@@ -0,0 +1,39 @@
+/*
+ * report.h
+ *
+ * Send-on-change filter in front of protocol_send().
+ *
+ * A reading is only transmitted if temperature or humidity moved by at least
+ * the configured delta since the last transmitted value of the same sensor
+ * ID. After REPORT_HEARTBEAT skipped readings a frame is sent anyway, so the
+ * receiver can tell the node is alive. Frames of one cycle are separated by
+ * a random nap (jitter.h).
+ */
+
+#ifndef REPORT_H_
+#define REPORT_H_
+
+#include <stdint.h>
+
+#include "main.h"
+
+#define REPORT_SLOTS		(JOB_DS18X20 + DS18X20_PROBES)	// one slot per sensor ID, the DS18X20 job has one per probe
+#define REPORT_HEARTBEAT	5	// send after this many skipped readings
+
+typedef struct {
+	uint8_t id;				// sensor ID
+	uint8_t protocol;		// PROTOCOL_* of protocol.h
+	uint8_t delta_temp;		// min. temperature change in 0.1 C, 0 = not watched
+	uint8_t delta_humidity;	// min. humidity change in 0.1 %, 0 = not watched
+	uint8_t skipped;		// readings skipped since the last transmission
+	uint8_t valid;			// last_* hold a transmitted value
+	int16_t last_temp;
+	uint16_t last_humidity;
+} report_slot_t;
+
+void report_init(uint8_t slot, uint8_t id, uint8_t protocol, uint8_t delta_temp, uint8_t delta_humidity);
+void report_invalidate(uint8_t slot);
+void report_cycle(void);
+uint16_t report_send(uint8_t slot, int16_t temperature, uint16_t humidity, uint8_t battery_ok);
+
+#endif /* REPORT_H_ */
@@ -0,0 +1,125 @@
+/*
+ * scheduler.c
+ *
+ * Cooperative job scheduler on top of watchdog_sleep().
+ * Time is counted in ticks of SCHEDULER_TICK_MS, slept with the calibrated
+ * watchdog_sleep_ms(). The time awake is added with scheduler_awake(), the
+ * part of a tick is carried, so the tick counter is the node's clock.
+ * All comparisons are done on differences, so the tick counter may wrap.
+ */
+
+#include "scheduler.h"
+#include "watchdog.h"
+#include "jitter.h"
+
+static scheduler_job_t _jobs[SCHEDULER_JOBS];
+static uint16_t _now = 0;
+static uint16_t _now_ms = 0;	// into the current tick
+static uint8_t _stretch = 0;
+
+// enable a job with the given period, it is due immediately
+void scheduler_init(uint8_t job, uint16_t period, uint16_t period_min, uint16_t period_max)
+{
+	_jobs[job].period = period;
+	_jobs[job].period_min = period_min;
+	_jobs[job].period_max = period_max;
+	_jobs[job].deadline = _now;
+	_jobs[job].jitter = 0;
+}
+
+// trend > 0: halve the period down to period_min
+// trend < 0: stretch the period by a quarter up to period_max
+// call before scheduler_done() to apply it to the next deadline
+void scheduler_adapt(uint8_t job, int8_t trend)
+{
+	scheduler_job_t *j = &_jobs[job];
+
+	if (!j->period) return;
+	if (trend > 0) {
+		j->period /= 2;
+	} else if (trend < 0) {
+		j->period += j->period / 4 + 1;
+		if (j->period > SCHEDULER_PERIOD_MAX) j->period = SCHEDULER_PERIOD_MAX;
+	}
+	// a bad range from the config only keeps the job running
+	if (j->period_min <= j->period_max) {
+		if (j->period < j->period_min) j->period = j->period_min;
+		if (j->period > j->period_max) j->period = j->period_max;
+	}
+	if (!j->period) j->period = 1; // 0 would disable the job
+}
+
+// period in ticks as scheduled: stretched, and short enough for the
+// signed deadline differences even with a bad period from the config
+uint16_t scheduler_period(uint8_t job)
+{
+	uint32_t period = (uint32_t)_jobs[job].period << _stretch;
+
+	return (period > SCHEDULER_PERIOD_MAX) ? SCHEDULER_PERIOD_MAX : period;
+}
+
+// clock in ticks, slept and awake time, wraps
+uint16_t scheduler_now(void)
+{
+	return _now;
+}
+
+// bitmask of all jobs due now or within SCHEDULER_WINDOW ticks
+uint8_t scheduler_due(void)
+{
+	uint8_t jobs = 0;
+	for (uint8_t i = 0; i < SCHEDULER_JOBS; i++) {
+		if (_jobs[i].period && (int16_t)(_jobs[i].deadline - _now) <= SCHEDULER_WINDOW) {
+			jobs |= (1 << i);
+		}
+	}
+	return jobs;
+}
+
+// move the deadlines of the finished jobs one period ahead
+// a job that fell behind restarts its period from now
+void scheduler_done(uint8_t jobs)
+{
+	for (uint8_t i = 0; i < SCHEDULER_JOBS; i++) {
+		if (!(jobs & (1 << i))) continue;
+		uint16_t period = scheduler_period(i);
+		_jobs[i].deadline += period - _jobs[i].jitter; // next nominal tick
+		if ((int16_t)(_jobs[i].deadline - _now) <= 0) {
+			_jobs[i].deadline = _now + period;
+		}
+		_jobs[i].jitter = jitter_ticks(period);
+		_jobs[i].deadline += _jobs[i].jitter;
+	}
+}
+
+// multiply all periods by 2^shift from the next deadline on, 0 = normal
+void scheduler_stretch(uint8_t shift)
+{
+	_stretch = shift;
+}
+
+// sleep until the next job is due, returns the number of ticks slept
+uint16_t scheduler_sleep(void)
+{
+	uint16_t wait = 0xFFFF;
+	for (uint8_t i = 0; i < SCHEDULER_JOBS; i++) {
+		if (!_jobs[i].period) continue;
+		int16_t left = _jobs[i].deadline - _now;
+		if (left <= 0) return 0;
+		if ((uint16_t)left < wait) wait = left;
+	}
+	if (wait == 0xFFFF) wait = 1; // no job enabled, just idle
+	watchdog_sleep_ms(wait * SCHEDULER_TICK_MS - _now_ms); // up to the tick boundary
+	_now += wait;
+	_now_ms = 0;
+	return wait;
+}
+
+// count ms spent awake, e.g. a measure() cycle, the remainder is carried
+void scheduler_awake(uint16_t ms)
+{
+	uint32_t total = (uint32_t)_now_ms + ms;
+
+	_now += total / SCHEDULER_TICK_MS;
+	_now_ms = total % SCHEDULER_TICK_MS;
+}
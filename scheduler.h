@@ -0,0 +1,47 @@
+/*
+ * scheduler.h
+ *
+ * Cooperative job scheduler on top of watchdog_sleep().
+ *
+ * Every job has its own period and deadline in watchdog ticks. The node only
+ * wakes up when a job is due, jobs that become due within SCHEDULER_WINDOW
+ * ticks of each other are run together in one power-up.
+ *
+ * The period of a job can be adapted at run time between period_min and
+ * period_max, e.g. from the rate of change of its readings. All periods can
+ * be stretched by a power of two, e.g. to save a weak battery.
+ *
+ * Each deadline is moved by a random offset of jitter_ticks() around its
+ * nominal time, a new one every period, so nodes started together drift
+ * apart.
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdint.h>
+
+#define SCHEDULER_JOBS		2	// max. number of jobs, job numbers 0..SCHEDULER_JOBS-1
+#define SCHEDULER_WINDOW	1	// run jobs early if due within this many ticks
+#define SCHEDULER_TICK_MS	8000UL	// one tick of real time, see watchdog_sleep_ms()
+#define SCHEDULER_PERIOD_MAX	0x4000	// stretched periods are cut here, deadlines are compared signed
+
+typedef struct {
+	uint16_t period;	// in watchdog ticks, 0 = job disabled
+	uint16_t period_min;
+	uint16_t period_max;
+	uint16_t deadline;	// tick at which the job is due next
+	int8_t jitter;		// random offset of the deadline from its nominal tick
+} scheduler_job_t;
+
+void scheduler_init(uint8_t job, uint16_t period, uint16_t period_min, uint16_t period_max);
+void scheduler_adapt(uint8_t job, int8_t trend);
+uint16_t scheduler_period(uint8_t job);
+uint16_t scheduler_now(void);
+uint8_t scheduler_due(void);
+void scheduler_done(uint8_t jobs);
+void scheduler_stretch(uint8_t shift);
+uint16_t scheduler_sleep(void);
+void scheduler_awake(uint16_t ms);
+
+#endif /* SCHEDULER_H_ */
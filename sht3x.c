@@ -0,0 +1,87 @@
+/*
+ * sht3x.c
+ *
+ * Sensirion SHT3x humidity and temperature sensor on the USI I2C bus.
+ *
+ * return values:
+ * 0: ok
+ * 1: no acknowledge for the measurement command (no sensor)
+ * 2: no acknowledge for the read (measurement not finished after the retries)
+ *    or the bus is stuck
+ * 3: checksum error
+ *
+ */
+
+#include "main.h"
+
+#ifdef USE_SHT3X
+
+#include "sht3x.h"
+#include "usi_i2c.h"
+#include "watchdog.h"
+
+// CRC-8, polynomial 0x31, init 0xFF
+static uint8_t _sht3x_crc(const uint8_t *data)
+{
+	uint8_t crc = 0xFF;
+
+	for (uint8_t i = 0; i < 2; i++) {
+		crc ^= data[i];
+		for (uint8_t b = 0; b < 8; b++) {
+			crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+		}
+	}
+	return crc;
+}
+
+// humidity in 0.1 %, temp in 0.1 C
+uint8_t sht3x(uint16_t *humidity, int16_t *temp)
+{
+	uint8_t data[6];
+	uint8_t retries = 0;
+
+	usi_i2c_init();
+
+	// single shot, high repeatability, no clock stretching
+	if (usi_i2c_start(SHT3X_ADDR << 1) || usi_i2c_write(0x24) || usi_i2c_write(0x00)) {
+		usi_i2c_stop();
+		usi_i2c_release();
+		return 1;
+	}
+	usi_i2c_stop();
+
+	watchdog_nap_ms(SHT3X_MEASURE_MS);
+
+	// the sensor does not acknowledge its address while measuring
+	while (1) {
+		uint8_t error = usi_i2c_start((SHT3X_ADDR << 1) | USI_I2C_READ);
+		if (!error) {
+			break;
+		}
+		usi_i2c_stop();
+		if (error != USI_I2C_NO_ACK || retries++ >= SHT3X_READ_RETRIES) {
+			usi_i2c_release();
+			return 2;
+		}
+		watchdog_nap_ms(SHT3X_RETRY_MS);
+	}
+	for (uint8_t i = 0; i < 6; i++) {
+		data[i] = usi_i2c_read(i < 5);
+	}
+	usi_i2c_stop();
+	usi_i2c_release();
+
+	if (_sht3x_crc(&data[0]) != data[2] || _sht3x_crc(&data[3]) != data[5]) {
+		return 3;
+	}
+
+	// T = -45 + 175 * raw / 65535, RH = 100 * raw / 65535
+	uint16_t raw = (data[0] << 8) | data[1];
+	*temp = (int16_t)(((uint32_t)raw * 1750) >> 16) - 450;
+	raw = (data[3] << 8) | data[4];
+	*humidity = ((uint32_t)raw * 1000) >> 16;
+
+	return 0;
+}
+
+#endif /* USE_SHT3X */
@@ -0,0 +1,23 @@
+/*
+ * sht3x.h
+ *
+ * Sensirion SHT3x humidity and temperature sensor on the USI I2C bus.
+ *
+ * Single shot measurement with high repeatability, about 15ms instead of
+ * the 2s warm-up of the AM2302. The result is in AM2302 units.
+ */
+
+#ifndef SHT3X_H_
+#define SHT3X_H_
+
+#include <stdint.h>
+
+#define SHT3X_ADDR			0x44	// ADDR pin low, 0x45 if high
+#define SHT3X_WARMUP_MS		1		// power-up time
+#define SHT3X_MEASURE_MS	32		// 15ms high repeatability, the watchdog is only good to +-10%
+#define SHT3X_RETRY_MS		16		// nap before another read if the sensor is still busy
+#define SHT3X_READ_RETRIES	2
+
+uint8_t sht3x(uint16_t *humidity, int16_t *temp);
+
+#endif /* SHT3X_H_ */
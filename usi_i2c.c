@@ -0,0 +1,134 @@
+/*
+ * usi_i2c.c
+ *
+ * I2C master on the USI in two-wire mode (AVR310).
+ */
+
+#include "main.h"
+
+#ifdef USE_SHT3X
+
+#include <avr/io.h>
+#include <util/delay.h>
+
+#include "usi_i2c.h"
+
+// standard mode timing in us
+#define USI_I2C_T_LOW	5
+#define USI_I2C_T_HIGH	4
+
+// clear the flags, count 16 (8 bit) or 2 (1 bit) clock edges
+#define USI_SR_8BIT	((1 << USISIF) | (1 << USIOIF) | (1 << USIPF) | (1 << USIDC) | (0x0 << USICNT0))
+#define USI_SR_1BIT	((1 << USISIF) | (1 << USIOIF) | (1 << USIPF) | (1 << USIDC) | (0xE << USICNT0))
+
+// two-wire mode, software clock strobe
+#define USI_CR_IDLE		((1 << USIWM1) | (1 << USICS1) | (1 << USICLK))
+#define USI_CR_TOGGLE	((1 << USIWM1) | (1 << USICS1) | (1 << USICLK) | (1 << USITC))
+
+#define SCL_is_low	(!(PIN_USI & (1 << PIN_SCL)))
+
+#define USI_I2C_STRETCH_STEPS	100	// max. clock stretching in 10us steps
+
+static uint8_t _usi_i2c_stuck = 0; // SCL held low longer than the timeout
+
+// wait while a slave stretches the clock, gives up after 1ms
+static void _usi_i2c_wait_scl(void)
+{
+	for (uint8_t i = 0; SCL_is_low; i++) {
+		if (i >= USI_I2C_STRETCH_STEPS) {
+			_usi_i2c_stuck = 1;
+			return;
+		}
+		_delay_us(10);
+	}
+}
+
+static uint8_t _usi_i2c_transfer(uint8_t sr)
+{
+	USISR = sr;
+	do {
+		_delay_us(USI_I2C_T_LOW);
+		USICR = USI_CR_TOGGLE; // SCL high
+		_usi_i2c_wait_scl(); // clock stretching
+		_delay_us(USI_I2C_T_HIGH);
+		USICR = USI_CR_TOGGLE; // SCL low
+	} while (!(USISR & (1 << USIOIF)));
+	_delay_us(USI_I2C_T_LOW);
+
+	uint8_t data = USIDR;
+	USIDR = 0xFF; // release SDA
+	DDR_USI |= (1 << PIN_SDA);
+	return data;
+}
+
+void usi_i2c_init(void)
+{
+	PORT_USI |= (1 << PIN_SDA) | (1 << PIN_SCL);
+	DDR_USI |= (1 << PIN_SDA) | (1 << PIN_SCL);
+	USIDR = 0xFF;
+	USICR = USI_CR_IDLE;
+	USISR = USI_SR_8BIT;
+	_usi_i2c_stuck = 0;
+}
+
+// both lines input low, before the sensor supply is switched off
+void usi_i2c_release(void)
+{
+	USICR = 0;
+	DDR_USI &= ~((1 << PIN_SDA) | (1 << PIN_SCL));
+	PORT_USI &= ~((1 << PIN_SDA) | (1 << PIN_SCL));
+}
+
+// start condition and address byte, addr is the 7 bit address << 1 | R/W
+uint8_t usi_i2c_start(uint8_t addr)
+{
+	PORT_USI |= (1 << PIN_SCL);
+	_usi_i2c_wait_scl();
+	_delay_us(USI_I2C_T_HIGH);
+	PORT_USI &= ~(1 << PIN_SDA);
+	_delay_us(USI_I2C_T_HIGH);
+	PORT_USI &= ~(1 << PIN_SCL);
+	PORT_USI |= (1 << PIN_SDA);
+
+	return usi_i2c_write(addr);
+}
+
+void usi_i2c_stop(void)
+{
+	PORT_USI &= ~(1 << PIN_SDA);
+	PORT_USI |= (1 << PIN_SCL);
+	_usi_i2c_wait_scl();
+	_delay_us(USI_I2C_T_HIGH);
+	PORT_USI |= (1 << PIN_SDA);
+	_delay_us(USI_I2C_T_LOW);
+}
+
+uint8_t usi_i2c_write(uint8_t data)
+{
+	PORT_USI &= ~(1 << PIN_SCL);
+	USIDR = data;
+	_usi_i2c_transfer(USI_SR_8BIT);
+
+	DDR_USI &= ~(1 << PIN_SDA); // slave acknowledge
+	uint8_t nack = _usi_i2c_transfer(USI_SR_1BIT) & 0x01;
+	if (_usi_i2c_stuck) {
+		return USI_I2C_TIMEOUT;
+	}
+	if (nack) {
+		return USI_I2C_NO_ACK;
+	}
+	return USI_I2C_OK;
+}
+
+// ack: 1 for more bytes to read, 0 after the last byte
+uint8_t usi_i2c_read(uint8_t ack)
+{
+	DDR_USI &= ~(1 << PIN_SDA);
+	uint8_t data = _usi_i2c_transfer(USI_SR_8BIT);
+
+	USIDR = ack ? 0x00 : 0xFF;
+	_usi_i2c_transfer(USI_SR_1BIT);
+	return data;
+}
+
+#endif /* USE_SHT3X */
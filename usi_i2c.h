@@ -0,0 +1,37 @@
+/*
+ * usi_i2c.h
+ *
+ * I2C master on the USI in two-wire mode (AVR310), SDA PB0, SCL PB2.
+ *
+ * The clock is strobed in software, at 1MHz the bus runs below 100kHz.
+ * Slaves may stretch the clock for up to 1ms, a bus held low longer is
+ * reported as USI_I2C_TIMEOUT instead of hanging.
+ */
+
+#ifndef USI_I2C_H_
+#define USI_I2C_H_
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#define DDR_USI		DDRB
+#define PORT_USI	PORTB
+#define PIN_USI		PINB
+#define PIN_SDA		PB0
+#define PIN_SCL		PB2
+
+#define USI_I2C_READ	1	// R/W bit of the address byte
+
+// return codes
+#define USI_I2C_OK			0
+#define USI_I2C_NO_ACK		1
+#define USI_I2C_TIMEOUT		2	// SCL stuck low, sticky until usi_i2c_init()
+
+void usi_i2c_init(void);
+void usi_i2c_release(void);
+uint8_t usi_i2c_start(uint8_t addr);
+void usi_i2c_stop(void);
+uint8_t usi_i2c_write(uint8_t data);
+uint8_t usi_i2c_read(uint8_t ack);
+
+#endif /* USI_I2C_H_ */
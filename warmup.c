@@ -0,0 +1,91 @@
+/*
+ * warmup.c
+ *
+ * Self-tuning AM2302 warm-up time.
+ */
+
+#include <avr/eeprom.h>
+
+#include "warmup.h"
+#include "config.h"
+
+static uint8_t _warmup_steps;	// current warm-up in WARMUP_STEP_MS
+static uint8_t _warmup_saved;	// value in EEPROM
+static uint8_t _warmup_good;	// good first reads in a row
+static uint8_t _warmup_probe;	// good first reads before trying a step shorter
+static uint8_t _warmup_probing;	// current value is a probe
+
+static void _warmup_save(void)
+{
+	if (_warmup_steps != _warmup_saved) {
+		eeprom_update_byte((uint8_t *)WARMUP_EEPROM_ADDR, _warmup_steps);
+		_warmup_saved = _warmup_steps;
+	}
+}
+
+uint16_t warmup_ms(void)
+{
+	return _warmup_steps * WARMUP_STEP_MS;
+}
+
+void warmup_init(void)
+{
+	uint8_t steps = eeprom_read_byte((const uint8_t *)WARMUP_EEPROM_ADDR);
+
+	if (steps < WARMUP_MIN_STEPS || steps > WARMUP_MAX_STEPS) {
+		steps = AM2302_WARMUP_MS / WARMUP_STEP_MS; // erased or not learned yet
+	}
+	_warmup_steps = steps;
+	_warmup_saved = steps;
+	_warmup_good = 0;
+	_warmup_probe = WARMUP_PROBE;
+	_warmup_probing = 0;
+}
+
+// result of the AM2302 read in this cycle
+// awake: ms since vcc_on() at the last attempt, retries: failed attempts before
+void warmup_learn(uint16_t awake, uint8_t retries, uint8_t error)
+{
+	if (error > 4) {
+		return; // transfer error, says nothing about the warm-up
+	}
+
+	if (error || retries) {
+		// too short: take the time that worked (or the next step)
+		uint8_t steps = (awake + WARMUP_STEP_MS - 1) / WARMUP_STEP_MS;
+		if (error) {
+			steps++;
+		}
+		if (steps > WARMUP_MAX_STEPS) {
+			steps = WARMUP_MAX_STEPS;
+		}
+		if (steps > _warmup_steps) {
+			_warmup_steps = steps;
+		}
+		if (_warmup_probing && _warmup_probe < WARMUP_PROBE_MAX) {
+			_warmup_probe <<= 1;
+		}
+		_warmup_probing = 0;
+		_warmup_good = 0;
+		_warmup_save();
+		return;
+	}
+
+	if (awake >= warmup_ms() + WARMUP_STEP_MS) {
+		return; // read late (other phases before), proves nothing
+	}
+
+	_warmup_good++;
+	if (_warmup_good == WARMUP_CONFIRM) {
+		if (_warmup_probing) {
+			_warmup_probe = WARMUP_PROBE;
+		}
+		_warmup_probing = 0;
+		_warmup_save();
+	}
+	if (_warmup_good >= _warmup_probe && _warmup_steps > WARMUP_MIN_STEPS) {
+		_warmup_steps--;
+		_warmup_probing = 1;
+		_warmup_good = 0;
+	}
+}
@@ -0,0 +1,31 @@
+/*
+ * warmup.h
+ *
+ * Self-tuning AM2302 warm-up time.
+ *
+ * The warm-up after vcc_on() is learned per node in steps of
+ * WARMUP_STEP_MS. A read failing with a warm-up error (1..4) is retried
+ * one step later, a read that needed retries raises the warm-up to the time
+ * that worked. After WARMUP_PROBE good reads in a row a step shorter is
+ * tried, a probe that fails doubles the interval until the next one.
+ * The value is stored in EEPROM after WARMUP_CONFIRM good reads or a raise.
+ */
+
+#ifndef WARMUP_H_
+#define WARMUP_H_
+
+#include <stdint.h>
+
+#define WARMUP_STEP_MS		250
+#define WARMUP_MIN_STEPS	2		// 0.5s
+#define WARMUP_MAX_STEPS	12		// 3s
+#define WARMUP_RETRIES		4		// warm-up errors retried per cycle
+#define WARMUP_CONFIRM		4		// good reads before a shorter value is stored
+#define WARMUP_PROBE		16		// good reads before a shorter value is tried
+#define WARMUP_PROBE_MAX	128
+
+uint16_t warmup_ms(void);
+void warmup_init(void);
+void warmup_learn(uint16_t awake, uint8_t retries, uint8_t error);
+
+#endif /* WARMUP_H_ */
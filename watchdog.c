@@ -23,7 +23,16 @@
 #include <avr/interrupt.h>
 
 #include "watchdog.h"
+#include "power.h"
+#include "am2302.h"
 
+static uint8_t _watchdog_prescaler = 9;
+static volatile uint8_t _watchdog_fired = 0;
+
+// calibrated length of the 16ms base period, see watchdog_calibrate()
+static uint16_t _watchdog_tick_us = WATCHDOG_TICK_US;
+static int16_t _watchdog_cal_temp = 0;
+static uint8_t _watchdog_cal_age = 0;
 
 #ifndef cbi
 #define cbi(sfr, bit) (_SFR_BYTE(sfr) &= ~_BV(bit))
@@ -91,6 +100,7 @@ void watchdog_init(uint8_t ii)
 	// This block moves ii into these bits
 	uint8_t bb;
 	if (ii > 9 ) ii = 9;
+	_watchdog_prescaler = ii;
 	bb = ii & 7;
 	if (ii > 7) bb |= _BV(WDP3);
 	bb |= _BV(WDCE);
@@ -114,37 +124,129 @@ void watchdog_sleep(uint16_t waitTime)
   wdt_reset();
   while (waitCounter < waitTime)
   {
-    cbi(ADCSRA, ADEN); // Switch Analog to Digital converter OFF 
-    set_sleep_mode(SLEEP_MODE_PWR_DOWN); // Set sleep mode
-    sleep_mode(); // System sleeps here
-    sbi(ADCSRA, ADEN);  // Switch Analog to Digital converter ON
+    power_down(0); // System sleeps here
     waitCounter++;
   }
 }
 
+// sleep ms of real time, based on the calibrated period length
+// uses the longest watchdog periods possible, the configured period is kept
+void watchdog_sleep_ms(uint32_t ms)
+{
+  uint8_t prescaler = _watchdog_prescaler;
+  uint32_t ticks = ms / _watchdog_tick_us * 1000 + (ms % _watchdog_tick_us) * 1000 / _watchdog_tick_us;
+
+  for (int8_t ii = 9; ii >= 0; ii--) {
+    uint32_t n = ticks >> ii;
+    if (!n) continue;
+    watchdog_init(ii);
+    while (n > 0xFFFF) {
+      watchdog_sleep(0xFFFF);
+      n -= 0xFFFF;
+    }
+    watchdog_sleep(n);
+    ticks &= (1UL << ii) - 1;
+  }
+  watchdog_init(prescaler);
+}
+
+// sleep once for the longest watchdog period not exceeding ms (at least 16ms)
+// and return the calibrated time slept in ms, the configured period is kept
+uint16_t watchdog_nap_ms(uint16_t ms)
+{
+  uint8_t ii = 0;
+  uint8_t prescaler = _watchdog_prescaler;
+  while (ii < 9 && (WATCHDOG_PERIOD_MS(ii + 1)) <= ms) ii++;
+  watchdog_init(ii);
+  watchdog_sleep(1);
+  watchdog_init(prescaler);
+  return ((uint32_t)_watchdog_tick_us << ii) / 1000;
+}
+
+// measure the real length of a watchdog period against the system clock
+// Timer1 counts at CK/16 from one watchdog interrupt to the next, the
+// watchdog oscillator is only specified to about +-10% and drifts with
+// temperature and supply voltage
+void watchdog_calibrate(void)
+{
+  uint8_t prescaler = _watchdog_prescaler;
+  uint8_t prr = PRR;
+  uint16_t count = 0;
+  uint8_t tcnt;
+
+  cbi(PRR, PRTIM1);
+  TCCR1 = 0;
+  watchdog_init(WATCHDOG_CAL_PRESCALER);
+  wdt_reset();
+
+  // start on a watchdog interrupt
+  _watchdog_fired = 0;
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  while (!_watchdog_fired) sleep_mode();
+  _watchdog_fired = 0;
+  TCNT1 = 0;
+  TIFR = _BV(TOV1);
+  TCCR1 = _BV(CS12) | _BV(CS10); // CK/16
+
+  while (!_watchdog_fired) {
+    if (TIFR & _BV(TOV1)) {
+      TIFR = _BV(TOV1);
+      count += 256;
+    }
+  }
+  tcnt = TCNT1;
+  TCCR1 = 0;
+  if ((TIFR & _BV(TOV1)) && tcnt < 128) count += 256; // overflow just before the stop
+  count += tcnt;
+
+  PRR = prr;
+  watchdog_init(prescaler);
+
+  // count of 16us over 2^WATCHDOG_CAL_PRESCALER base periods
+  uint32_t tick_us = ((uint32_t)count * (16000000UL / F_CPU)) >> WATCHDOG_CAL_PRESCALER;
+  if (tick_us > WATCHDOG_TICK_US / 2 && tick_us < WATCHDOG_TICK_US * 2) {
+    _watchdog_tick_us = tick_us;
+  }
+}
+
+// recalibrate if the temperature moved by WATCHDOG_CAL_DELTA_TEMP (0.1 C)
+// since the last calibration or every WATCHDOG_CAL_INTERVAL calls
+void watchdog_compensate(int16_t temperature)
+{
+  int16_t diff = temperature - _watchdog_cal_temp;
+
+  if (++_watchdog_cal_age >= WATCHDOG_CAL_INTERVAL
+    || diff >= WATCHDOG_CAL_DELTA_TEMP || diff <= -WATCHDOG_CAL_DELTA_TEMP)
+  {
+    watchdog_calibrate();
+    _watchdog_cal_temp = temperature;
+    _watchdog_cal_age = 0;
+  }
+}
+
+uint16_t watchdog_tick_us(void)
+{
+  return _watchdog_tick_us;
+}
+
 void watchdog_sleepPCINT0(void)
 {
   wdt_reset();
-  cbi(ADCSRA,ADEN); // Switch Analog to Digital converter OFF 
   sbi(PCMSK,PCINT0); // Enable PCINT0 interrupt
-  set_sleep_mode(SLEEP_MODE_PWR_DOWN); // Set sleep mode
-  sleep_enable();
   sbi(GIFR,PCIF); // reset old Pin Change interrupt
   sbi(GIMSK,PCIE); // enable Pin Change interrupts
-  sleep_cpu(); // System sleeps here
+  power_down(_BV(PB0)); // System sleeps here
   cli();
   cbi(GIMSK,PCIE);
-  sleep_disable();
   sei();
-  sbi(ADCSRA,ADEN);  // Switch Analog to Digital converter ON
 }
 
 ISR(WDT_vect)
 {
-  // Don't do anything here but we must include this
-  // block of code otherwise the interrupt calls an
-  // uninitialized interrupt handler.
+  _watchdog_fired = 1;
 }
 
+#ifndef AM2302_CAPTURE // the AM2302 edge capture owns the pin change interrupt
 ISR(PCINT0_vect) {}
+#endif
 
@@ -20,8 +20,23 @@
 #ifndef WATCHDOG_H_
 #define WATCHDOG_H_
 
+#include <stdint.h>
+
+// nominal length of watchdog period ii in ms (2048 cycles of the 128kHz oscillator)
+#define WATCHDOG_PERIOD_MS(ii)	(16U << (ii))
+#define WATCHDOG_TICK_US		16000	// nominal length of the base period 0
+
+#define WATCHDOG_CAL_PRESCALER		2	// calibrate on the 64ms period
+#define WATCHDOG_CAL_DELTA_TEMP		20	// recalibrate after 2 C of change
+#define WATCHDOG_CAL_INTERVAL		64	// or after this many watchdog_compensate() calls
+
 void watchdog_init(uint8_t ii);
 void watchdog_sleep(uint16_t waitTime);
+void watchdog_sleep_ms(uint32_t ms);
+uint16_t watchdog_nap_ms(uint16_t ms);
+void watchdog_calibrate(void);
+void watchdog_compensate(int16_t temperature);
+uint16_t watchdog_tick_us(void);
 void watchdog_sleepPCINT0(void);
 
 #endif /* WATCHDOG_H_ */